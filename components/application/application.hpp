@@ -16,10 +16,12 @@
 #include "boards_manager.hpp"
 #include "board.hpp"
 #include "message.hpp"
+#include "voltages_delta_encoder.hpp"
 
 class Application {
   public:
     using IPv4 = uint32_t;
+    using Byte = uint8_t;
     using Comm = Communicator<MessageToMaster>;
 
     static void Run() noexcept { _this = std::shared_ptr<Application>(new Application()); }
@@ -63,10 +65,10 @@ class Application {
         Initialize();
         ConnectWireless();
 
-        auto fromMasterMsgQ = std::make_shared<Queue<MessageFromMaster>>(10);
-        auto toMasterSB     = std::make_shared<ByteStreamBuffer>(256);
+        auto fromMasterMsgQ = std::make_shared<Queue<MessageFromMaster>>(ProjCfg::Socket::CommandsQueueLength);
+        auto toMasterFrames = std::make_shared<Comm::ToMasterFrames>();
 
-        communicator = std::make_shared<Comm>(masterIP, ProjCfg::Socket::EntryPortNumber, toMasterSB, fromMasterMsgQ);
+        communicator = std::make_shared<Comm>(masterIP, ProjCfg::Socket::EntryPortNumber, toMasterFrames, fromMasterMsgQ);
         communicator->run();
 
         Apparatus::Create(communicator);
@@ -79,8 +81,8 @@ class Application {
 
     [[noreturn]] void CommandManagerTask() noexcept
     {
-        auto from_master_q = communicator->GetFromMasterCommandsQ();
-        auto to_master_sb  = communicator->GetToMasterSB();
+        auto from_master_q    = communicator->GetFromMasterCommandsQ();
+        auto commands_pending = communicator->GetCommandsPendingSemaphore();
 
         while (not apparatus->BoardsSearchPerformed()) {
             Task::DelayMs(100);
@@ -89,9 +91,12 @@ class Application {
         communicator->UnsetNotInitializedFlagResponse();
 
         while (true) {
-            auto msg = from_master_q->Receive();
+            // control lane goes first, it is also served by running scan between its steps
+            apparatus->ProcessControlCommands();
+
+            auto msg = from_master_q->Receive(0);
             if (msg == std::nullopt) {
-                console.LogError("CMT: Message arrived is null");
+                commands_pending->Take_BlockInfinitely();
                 continue;
             }
 
@@ -100,12 +105,14 @@ class Application {
             auto cmd_id = msg->GetCommandID();
             switch (cmd_id) {
             case ID::GetBoards: {
-                to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
+                communicator->Acknowledge(*msg);
                 console.Log("FromMasterCMD: Get boards " + std::to_string(msg->cmd.getBoards.performRescan));
 
                 auto boards_info = apparatus->GetBoards(msg->cmd.getBoards.performRescan);
                 if (boards_info == std::nullopt) {
                     console.LogError("Get boards command failed!");
+                    if (msg->IsTagged())
+                        communicator->ReportCompletion(*msg, false);
                     continue;
                 }
 
@@ -115,52 +122,137 @@ class Application {
                     console.Log(std::to_string(counter) + ":" + std::to_string(byte));
                     counter++;
                 }
-                to_master_sb->Send(bytes);
+                Respond(*msg, bytes);
                 console.Log("CMT: response with boards sent!");
             } break;
             case ID::MeasureAll: {
-                to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
+                communicator->Acknowledge(*msg);
                 console.Log("FromMasterCMD: MeasureAll");
 
                 auto result = apparatus->MeasureAll();
                 if (result == std::nullopt) {
-                    to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandPerformanceFailure).Serialize());
+                    communicator->ReportCompletion(*msg, false);
                     continue;
                 }
                 else {
-                    to_master_sb->Send(result->Serialize());
+                    Respond(*msg, result->Serialize());
+                }
+            } break;
+            case ID::MeasureAllDelta: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: MeasureAllDelta");
+
+                auto result = apparatus->MeasureAll();
+                if (result == std::nullopt) {
+                    communicator->ReportCompletion(*msg, false);
+                    continue;
+                }
+
+                auto const &args = msg->cmd.measureAllDelta;
+                auto        delta =
+                  voltagesDeltaEncoder.Encode(result->GetBoardsVoltages(), args.acknowledgedFrame, args.deadband);
+
+                // delta is applicable only to master's snapshot, observers get keyframes which stand on their own
+                if (delta.IsKeyframe())
+                    Respond(*msg, delta.Serialize());
+                else
+                    communicator->SendToMasterOnly(msg->GetRequestId(), delta.Serialize());
+            } break;
+            case ID::MeasureAllHiRes: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: MeasureAllHiRes");
+
+                auto result = apparatus->MeasureAllHiRes();
+                if (result == std::nullopt) {
+                    communicator->ReportCompletion(*msg, false);
+                    continue;
+                }
+                else {
+                    Respond(*msg, result->Serialize());
                 }
             } break;
             case ID::CheckConnections: {
-                to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
+                communicator->Acknowledge(*msg);
                 console.Log("FromMasterCMD: CheckAllConnections");
 
+                // completion of tagged scan is reported by apparatus, scan may be paused and resumed later
                 if (msg->cmd.checkConnections.measureAll) {
-                    apparatus->CheckAllConnections();
+                    apparatus->CheckAllConnections(msg->GetRequestId());
                 }
                 else {
                     console.Log("Check connection received");
 
-                    apparatus->CheckConnection(Board::PinAffinityAndId{ msg->cmd.checkConnections.boardAffinity,
-                                                                        msg->cmd.checkConnections.pinNumber });
+                    auto success =
+                      apparatus->CheckConnection(Board::PinAffinityAndId{ msg->cmd.checkConnections.boardAffinity,
+                                                                          msg->cmd.checkConnections.pinNumber },
+                                                 msg->GetRequestId());
+                    if (msg->IsTagged() and not success)
+                        communicator->ReportCompletion(*msg, false);
                 }
 
             } break;
-            case ID::DataLinkKeepAlive: {
-                to_master_sb->Send(KeepAlive().Serialize());
-                console.Log("KeepAlive message from master, sending keepalive back!");
+            case ID::ScanNetlist: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: ScanNetlist");
+
+                // netlist and completion of tagged scan are sent by apparatus when scan completes
+                apparatus->CheckAllConnectionsAsNetlist(msg->cmd.scanNetlist.withVoltages, msg->GetRequestId());
+            } break;
+            case ID::CheckPinsBatch: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: CheckPinsBatch");
+
+                // listed pins are checked as one scan, its completion is reported by apparatus
+                apparatus->CheckPinsBatch(msg->cmd.checkPinsBatch, msg->GetRequestId());
             } break;
-            case ID::EnableOutputForPin: {
-                to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
-                apparatus->EnableOutputForPin(msg->cmd.enableOutputForPin.pinAffinityAndId);
+            case ID::ScanBoards: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: ScanBoards");
+
+                apparatus->ScanBoards(msg->cmd.scanBoards, msg->GetRequestId());
             } break;
+            case ID::MonitorBoards: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: MonitorBoards");
 
-            case ID::DisableOutput: {
-                to_master_sb->Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
-                apparatus->DisableOutput();
+                // runs until cancelled, control lane stays served between pin steps
+                apparatus->MonitorBoards(msg->cmd.scanBoards, msg->GetRequestId());
+            } break;
+            case ID::WiggleTest: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: WiggleTest");
+
+                // runs until cancelled, summaries are sent periodically
+                apparatus->WiggleTest(msg->cmd.wiggleTest, msg->GetRequestId());
+            } break;
+            case ID::SetOversampling: {
+                communicator->Acknowledge(*msg);
+                apparatus->SetOversampling(msg->cmd.setOversampling);
+                if (msg->IsTagged())
+                    communicator->ReportCompletion(*msg, true);
+            } break;
+            case ID::SetCacheWindow: {
+                communicator->Acknowledge(*msg);
+                apparatus->SetCacheWindow(msg->cmd.setCacheWindow.windowMs);
+                if (msg->IsTagged())
+                    communicator->ReportCompletion(*msg, true);
             } break;
+            case ID::ResumeScan: {
+                communicator->Acknowledge(*msg);
+                console.Log("FromMasterCMD: ResumeScan");
 
-            case ID::Dummy: to_master_sb->Send(Dummy{}.Serialize()); break;
+                auto outcome = apparatus->ResumeScan();
+                if (msg->IsTagged())
+                    communicator->ReportCompletion(*msg, outcome != std::nullopt);
+            } break;
+            case ID::EnableOutputForPin: {
+                communicator->Acknowledge(*msg);
+                apparatus->EnableOutputForPin(msg->cmd.enableOutputForPin.pinAffinityAndId);
+                if (msg->IsTagged())
+                    communicator->ReportCompletion(*msg, true);
+            } break;
+
+            case ID::Dummy: Respond(*msg, Dummy{}.Serialize()); break;
             default: console.LogError("Unhandled command arrived! " + std::to_string(ToUnderlying(cmd_id))); break;
             }
         }
@@ -169,6 +261,11 @@ class Application {
   private:
     Application() = default;
 
+    void Respond(MessageFromMaster const &msg, std::vector<Byte> const &bytes) noexcept
+    {
+        communicator->Send(msg.GetRequestId(), bytes);
+    }
+
     static std::shared_ptr<Application> _this;
 
     Logger console{ "Main", ProjCfg::EnableLogForComponent::Main };
@@ -181,4 +278,5 @@ class Application {
 
     std::shared_ptr<Comm>      communicator;
     std::shared_ptr<Apparatus> apparatus;
+    VoltagesDeltaEncoder       voltagesDeltaEncoder;
 };
\ No newline at end of file
@@ -3,20 +3,38 @@
 #include <esp_event.h>
 #include <tcpip_adapter.h>
 #include <esp_wifi.h>
+#include <esp_system.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 #include "asio.hpp"
 #include "../../proj_cfg/project_configs.hpp"
 #include "esp_logger.hpp"
 #include "task.hpp"
 #include "queue.hpp"
+#include "frame_pool.hpp"
+#include "my_mutex.hpp"
+#include "semaphore.hpp"
 #include "message.hpp"
+#include "replay_ring.hpp"
+#include "observer_session.hpp"
+#include "telemetry_stream.hpp"
 
 template<typename MessageToMasterT>
 class Communicator {
   public:
-    using PortNumT    = unsigned short;
-    using Byte        = uint8_t;
-    using FromMasterQ = Queue<MessageFromMaster>;
+    using PortNumT       = unsigned short;
+    using Byte           = uint8_t;
+    using FromMasterQ    = Queue<MessageFromMaster>;
+    using ToMasterFrames = FramePool<ProjCfg::Socket::OutboundFramesNumber, ProjCfg::Socket::OutboundFrameCapacity>;
+    using TimeoutMsec    = typename ToMasterFrames::TimeoutMsec;
+    using ReplayBuffer   = ReplayRing<ProjCfg::Socket::ReplayMessagesNumber, ProjCfg::Socket::OutboundFrameCapacity>;
+    using RequestIdT     = MessageFromMaster::RequestIdT;
+    using Observer =
+      ObserverSession<ProjCfg::Socket::ObserverQueueLength, ProjCfg::Socket::OutboundFrameCapacity>;
 
     enum MessageType {
         Confirmation = 1
@@ -24,28 +42,35 @@ class Communicator {
 
     Communicator(asio::ip::address_v4              ip_addr,
                  PortNumT                          port_num,
-                 std::shared_ptr<ByteStreamBuffer> toMasterSB,
+                 std::shared_ptr<ToMasterFrames>   to_master_frames,
                  std::shared_ptr<FromMasterQ>      fromMasterQ) noexcept
       : masterIP{ std::move(ip_addr) }
       , currentSocketPort{ port_num }
       , io_context{ std::make_shared<asio::io_context>() }
       , socket{ std::make_shared<asio::ip::tcp::socket>(*io_context) }
       , endpoint{ std::make_shared<asio::ip::tcp::endpoint>(masterIP, currentSocketPort) }
-      , toMasterSB{ std::move(toMasterSB) }
+      , masterSilenceTimer{ *io_context }
+      , reconnectTimer{ *io_context }
+      , resumeWaitTimer{ *io_context }
+      , observersAcceptor{ *io_context }
+      , acceptedObserverSocket{ *io_context }
+      , telemetry{ *io_context }
+      , toMasterFrames{ std::move(to_master_frames) }
       , fromMasterCommandsQ{ std::move(fromMasterQ) }
-      , writeTask([this]() { WriteTask(); },
-                  ProjCfg::Tasks::CommunicatorWriteStackSize,
-                  ProjCfg::Tasks::CommunicatorWritePrio,
-                  "write",
-                  ProjCfg::Tasks::CommunicatorWriteTaskCore,
-                  true)
-      , readTask([this]() { ReadTask(); },
-                 ProjCfg::Tasks::CommunicatorReadTaskSize,
-                 ProjCfg::Tasks::CommunicatorReadPrio,
-                 "read",
-                 ProjCfg::Tasks::CommunicatorReadTaskCore,
-                 true)
-    { }
+      , controlCommandsQ{ std::make_shared<FromMasterQ>(ProjCfg::Socket::ControlQueueLength) }
+      , commandsPending{ std::make_shared<Semaphore>() }
+      , ioTask([this]() { IoTask(); },
+               ProjCfg::Tasks::CommunicatorIoStackSize,
+               ProjCfg::Tasks::CommunicatorIoPrio,
+               "socket_io",
+               ProjCfg::Tasks::CommunicatorIoTaskCore,
+               true)
+    {
+        writeBuffers.reserve(ProjCfg::Socket::ReplayMessagesNumber);
+
+        for (auto &observer : observers)
+            observer = std::make_unique<Observer>(*io_context);
+    }
 
     void run() noexcept
     {
@@ -56,6 +81,7 @@ class Communicator {
         }
 
         currentSocketPort = *working_port;
+        cachedWorkingPort = currentSocketPort;
 
         console.Log("Obtained working port! Port id: " + std::to_string(currentSocketPort));
         ConfirmOperation(true);
@@ -83,10 +109,24 @@ class Communicator {
 
         if (!err_code) {
             console.Log("Connected to working socket! Port: " + std::to_string(currentSocketPort));
-            console.Log("Starting write and read tasks!");
 
-            writeTask.Start();
-            readTask.Start();
+            // small result frames should go out immediately instead of waiting for delayed ACK of previous ones
+            socket->set_option(asio::ip::tcp::no_delay(true), err_code);
+            if (err_code)
+                console.LogError("Failed to disable Nagle algorithm: " + err_code.message());
+
+            socket->set_option(asio::socket_base::keep_alive(true), err_code);
+
+            PrepareSessionHello();
+            asio::write(*socket, SessionHelloBuffers(), err_code);
+            if (err_code)
+                console.LogError("Session hello write failed: " + err_code.message());
+
+            linkIsUp = true;
+
+            console.Log("Starting socket io task!");
+
+            ioTask.Start();
         }
         else {
             console.LogError("Error upon connection!:" + err_code.message());
@@ -94,86 +134,632 @@ class Communicator {
     }
 
     std::shared_ptr<FromMasterQ> GetFromMasterCommandsQ() noexcept { return fromMasterCommandsQ; }
+    std::shared_ptr<FromMasterQ> GetControlCommandsQ() noexcept { return controlCommandsQ; }
+    /**
+     * @brief given each time command is put into any of the commands queues
+     */
+    std::shared_ptr<Semaphore> GetCommandsPendingSemaphore() noexcept { return commandsPending; }
+
+    /**
+     * @brief thread safe, may be called from any task except socket io task itself. Message is copied into a frame
+     * claimed from the pool, messages which do not fit into one frame are streamed as sequence of MessageChunk frames
+     * with stream id of their own, writer is woken after each chunk so frames are drained while the rest is being
+     * filled. Messages sent by other tasks may be placed between chunks.
+     * @param timeout applies to every frame separately
+     */
+    bool Send(std::vector<Byte> const &bytes, TimeoutMsec timeout = portMAX_DELAY) noexcept
+    {
+        return SendGathered(ByteSpan{}, ByteSpan{ bytes.data(), bytes.size() }, false, timeout);
+    }
+    /**
+     * @brief response to command with given request id, wrapped into TaggedMessage if command was tagged
+     */
+    bool Send(RequestIdT request_id, std::vector<Byte> const &bytes, TimeoutMsec timeout = portMAX_DELAY) noexcept
+    {
+        return SendTagged(request_id, bytes, false, timeout);
+    }
+    /**
+     * @brief same as Send() with request id but the message is not copied to observers, for messages which make sense
+     * only together with state kept for master's session
+     */
+    bool SendToMasterOnly(RequestIdT               request_id,
+                          std::vector<Byte> const &bytes,
+                          TimeoutMsec              timeout = portMAX_DELAY) noexcept
+    {
+        return SendTagged(request_id, bytes, true, timeout);
+    }
+
+    /**
+     * @brief tagged commands are acknowledged by socket io task as soon as they are queued
+     */
+    void Acknowledge(MessageFromMaster const &msg) noexcept
+    {
+        if (not msg.IsTagged())
+            Send(CommandStatus(CommandStatus::Answer::CommandAcknowledge).Serialize());
+    }
+    void ReportCompletion(MessageFromMaster const &msg, bool success) noexcept
+    {
+        ReportCompletion(msg.GetRequestId(), success);
+    }
+    void ReportCompletion(RequestIdT request_id, bool success) noexcept
+    {
+        Send(request_id,
+             CommandStatus(success ? CommandStatus::Answer::CommandPerformanceSuccess
+                                   : CommandStatus::Answer::CommandPerformanceFailure)
+               .Serialize());
+    }
 
-    std::shared_ptr<ByteStreamBuffer> GetToMasterSB() noexcept { return toMasterSB; }
+    /**
+     * @brief latest scan position for telemetry stream, cheap enough to be called after every pin
+     */
+    void PublishScanProgress(ScanProgress const &progress) noexcept { telemetry.Publish(progress); }
 
     void SetImmediateAutoResponse(CommandStatus &&response) noexcept { *immediateAutoResponse = std::move(response); }
     void UnsetNotInitializedFlagResponse() noexcept { immediateAutoResponse = std::nullopt; }
 
   protected:
-    [[noreturn]] void WriteTask() noexcept
+    /**
+     * @brief the only task operating on socket after connection, all reads, writes and timers are asynchronous
+     * operations chained on io_context
+     */
+    [[noreturn]] void IoTask() noexcept
     {
-        asio::error_code err_code;
+        StartReadingMessageSize();
+        RestartMasterSilenceTimer();
+        StartAcceptingObservers();
+        StartWrite();
+
         while (true) {
-            auto bytes_to_be_sent = toMasterSB->Receive();
+            io_context->run();
+            io_context->restart();
+        }
+    }
+
+    /**
+     * @brief sends messages from replay ring with their length headers in one gather write, messages already waiting
+     * are coalesced into the same write up to MTU sized budget. Nothing is sent while link is down or while waiting for
+     * master to tell where to resume from.
+     */
+    void StartWrite() noexcept
+    {
+        writerNotificationPending.store(false);
+
+        AbsorbOutgoingMessages();
+
+        if (writeInProgress or not linkIsUp or awaitingResume or not replayRing.HasUnsent())
+            return;
+
+        auto batch_size = size_t{ 0 };
+        auto seq        = replayRing.SendPosition();
+
+        writeBuffers.clear();
+        for (; seq != replayRing.EndPosition() and batch_size < ProjCfg::Socket::WriteCoalescingBudgetBytes; seq++) {
+            auto &slot = replayRing.At(seq);
+            writeBuffers.push_back(asio::buffer(&slot.size, sizeof(size_t) + slot.size));
+            batch_size += sizeof(size_t) + slot.size;
+        }
+
+        writeInProgress = true;
+        asio::async_write(*socket, writeBuffers, [this, seq](asio::error_code const &err_code, size_t bytes_written) {
+            writeInProgress = false;
+
+            if (err_code) {
+                OnLinkError("Failed to send messages to master! Err: " + err_code.message());
+                return;
+            }
 
-            if (bytes_to_be_sent == std::nullopt) {
-                console.LogError("Message to be sent to master is unhealthy! Failed to obtain message len");
+            console.Log(std::to_string(seq - replayRing.SendPosition()) + " messages, " +
+                        std::to_string(bytes_written) + " bytes sent to master!");
+            replayRing.MarkSent(seq);
+            StartWrite();
+        });
+    }
+    /**
+     * @brief moves messages waiting in frame pool and in internal queue to replay ring, so producers keep running while
+     * link is down until replay ring is full of messages which were not sent yet
+     */
+    void AbsorbOutgoingMessages() noexcept
+    {
+        while (not writeQueue.empty()) {
+            if (writeQueue.front().size() > ReplayBuffer::capacity) {
+                console.LogError("Message is too large for replay buffer, dropped");
+                writeQueue.pop_front();
                 continue;
             }
 
-            auto message_size = bytes_to_be_sent->size();
+            // order of messages is kept, pool frames wait until internal messages are stored
+            if (not StoreForSending(ByteSpan{ writeQueue.front().data(), writeQueue.front().size() }, false))
+                return;
+
+            writeQueue.pop_front();
+        }
+
+        while (replayRing.CanStore()) {
+            auto frame_index = toMasterFrames->TakeCommitted();
+            if (frame_index == std::nullopt)
+                break;
 
-            asio::write(*socket, asio::buffer(&message_size, sizeof(message_size)));
-            asio::write(*socket, asio::buffer(bytes_to_be_sent->data(), bytes_to_be_sent->size()));
-            console.Log(std::to_string(message_size) + " bytes sent to master!");
+            auto &frame = toMasterFrames->At(*frame_index);
+            StoreForSending(ByteSpan{ frame.bytes.data(), frame.size }, frame.isPrivate);
+            toMasterFrames->Release(*frame_index);
         }
     }
+    /**
+     * @brief stores message for master and hands its copy to every connected observer unless message is master only
+     */
+    bool StoreForSending(ByteSpan message, bool master_only) noexcept
+    {
+        if (not replayRing.Store(message))
+            return false;
+
+        if (master_only)
+            return true;
 
-    [[noreturn]] void ReadTask() noexcept
+        for (auto &observer : observers)
+            observer->Offer(message);
+
+        return true;
+    }
+    /**
+     * @brief observers connect to device on their own port and receive copy of everything sent to master, failure to
+     * open the port only disables observers
+     */
+    void StartAcceptingObservers() noexcept
     {
-        auto message_size_buffer = int{};
-        auto main_buffer         = std::array<Byte, 256>{};
-        auto err_code            = asio::error_code();
+        auto err_code           = asio::error_code();
+        auto observers_endpoint = asio::ip::tcp::endpoint(asio::ip::tcp::v4(), ProjCfg::Socket::ObserverPortNumber);
+
+        observersAcceptor.open(observers_endpoint.protocol(), err_code);
+        if (not err_code)
+            observersAcceptor.set_option(asio::socket_base::reuse_address(true), err_code);
+        if (not err_code)
+            observersAcceptor.bind(observers_endpoint, err_code);
+        if (not err_code)
+            observersAcceptor.listen(ProjCfg::Socket::MaxObservers, err_code);
+
+        if (err_code) {
+            console.LogError("Observers port is not available! Err: " + err_code.message());
+            return;
+        }
 
-        while (true) {
-            asio::read(*socket, asio::buffer(&message_size_buffer, sizeof(message_size_buffer)), err_code);
+        AcceptObserver();
+    }
+    void AcceptObserver() noexcept
+    {
+        observersAcceptor.async_accept(acceptedObserverSocket, [this](asio::error_code const &err_code) {
+            if (err_code == asio::error::operation_aborted)
+                return;
 
             if (err_code)
-                console.OnFatalErrorTermination("Failed to get the size of message from master! Err:  " + err_code.message());
+                console.LogError("Observer accept failed! Err: " + err_code.message());
+            else {
+                auto free_session = std::find_if(observers.begin(), observers.end(), [](auto const &observer) {
+                    return observer->IsFree();
+                });
+
+                if (free_session == observers.end()) {
+                    console.LogError("Observers limit reached, connection refused");
+                    auto close_err = asio::error_code();
+                    acceptedObserverSocket.close(close_err);
+                }
+                else {
+                    console.Log("Observer connected");
+                    (*free_session)->Attach(std::move(acceptedObserverSocket));
+                }
+            }
+
+            AcceptObserver();
+        });
+    }
+    /**
+     * @brief sends head immediately followed by body as one message, without joining them in intermediate buffer
+     */
+    bool SendTagged(RequestIdT               request_id,
+                    std::vector<Byte> const &bytes,
+                    bool                     master_only,
+                    TimeoutMsec              timeout) noexcept
+    {
+        if (request_id == MessageFromMaster::untaggedRequestId)
+            return SendGathered(ByteSpan{}, ByteSpan{ bytes.data(), bytes.size() }, master_only, timeout);
 
-            auto message_size   = message_size_buffer;
-            auto bytes_read_num = asio::read(*socket,
-                                             asio::buffer(main_buffer.data(), main_buffer.size()),
-                                             asio::transfer_exactly(message_size),
-                                             err_code);
+        std::array<Byte, TaggedMessage::headerSize> header{};
+        TaggedMessage::SerializeHeaderTo(header.data(), request_id);
 
-            if (message_size != bytes_read_num) {
-                console.LogError("Message size is " + std::to_string(bytes_read_num) +
-                                 " and is different from expected: " + std::to_string(message_size));
-                continue;
+        return SendGathered(ByteSpan{ header.data(), header.size() },
+                            ByteSpan{ bytes.data(), bytes.size() },
+                            master_only,
+                            timeout);
+    }
+    bool SendGathered(ByteSpan head, ByteSpan body, bool master_only, TimeoutMsec timeout) noexcept
+    {
+        auto message_size = head.size() + body.size();
+
+        if (message_size <= ToMasterFrames::capacity) {
+            auto frame_index = toMasterFrames->Claim(timeout);
+            if (not frame_index)
+                return false;
+
+            auto &frame = toMasterFrames->At(*frame_index);
+            CopyGathered(head, body, 0, message_size, frame.bytes.data());
+            frame.size      = message_size;
+            frame.isPrivate = master_only;
+            toMasterFrames->Commit(*frame_index);
+            NotifyWriter();
+
+            return true;
+        }
+
+        // single frame messages of other tasks may get between chunks, they are told apart by stream id. Chunked
+        // messages are sent one at a time, so master reassembles at most one of them at once
+        std::lock_guard<Mutex> chunked_send_lock{ chunkedSendMutex };
+
+        auto const stream_id = nextChunkStreamId++;
+
+        auto constexpr chunk_payload_size = ToMasterFrames::capacity - MessageChunk::headerSize;
+        for (size_t offset = 0; offset < message_size; offset += chunk_payload_size) {
+            auto fragment_size = std::min(message_size - offset, chunk_payload_size);
+            auto is_last       = offset + fragment_size == message_size;
+
+            auto frame_index = toMasterFrames->Claim(timeout);
+            if (not frame_index) {
+                console.LogError("Chunked message send failed at offset " + std::to_string(offset));
+                return false;
+            }
+
+            auto &frame       = toMasterFrames->At(*frame_index);
+            auto  header_size = MessageChunk::SerializeHeaderTo(frame.bytes.data(), stream_id, is_last);
+            CopyGathered(head, body, offset, fragment_size, frame.bytes.data() + header_size);
+            frame.size      = header_size + fragment_size;
+            frame.isPrivate = master_only;
+            toMasterFrames->Commit(*frame_index);
+            NotifyWriter();
+        }
+
+        return true;
+    }
+    /**
+     * @brief copies bytes_num bytes starting at offset of virtual concatenation of head and body
+     */
+    static void CopyGathered(ByteSpan head, ByteSpan body, size_t offset, size_t bytes_num, Byte *destination) noexcept
+    {
+        if (offset < head.size()) {
+            auto from_head = std::min(bytes_num, head.size() - offset);
+            std::copy(head.begin() + offset, head.begin() + offset + from_head, destination);
+
+            destination += from_head;
+            bytes_num -= from_head;
+            offset = 0;
+        }
+        else {
+            offset -= head.size();
+        }
+
+        std::copy(body.begin() + offset, body.begin() + offset + bytes_num, destination);
+    }
+    /**
+     * @brief wakes socket writer, repeated notifications before writer runs are coalesced into one
+     */
+    void NotifyWriter() noexcept
+    {
+        if (writerNotificationPending.exchange(true))
+            return;
+
+        asio::post(*io_context, [this]() { StartWrite(); });
+    }
+    /**
+     * @brief for messages originating from socket io task itself, which must never block on frame pool
+     */
+    void QueueForWrite(std::vector<Byte> &&bytes) noexcept
+    {
+        writeQueue.push_back(std::move(bytes));
+        StartWrite();
+    }
+
+    void StartReadingMessageSize() noexcept
+    {
+        asio::async_read(*socket,
+                         asio::buffer(&incomingMessageSize, sizeof(incomingMessageSize)),
+                         [this](asio::error_code const &err_code, size_t) {
+                             if (err_code) {
+                                 OnLinkError("Failed to get the size of message from master! Err:  " +
+                                             err_code.message());
+                                 return;
+                             }
+
+                             if (incomingMessageSize <= 0 or incomingMessageSize > receiveBuffer.size()) {
+                                 OnLinkError("Message size from master is invalid: " +
+                                             std::to_string(incomingMessageSize));
+                                 return;
+                             }
+
+                             StartReadingMessage();
+                         });
+    }
+    void StartReadingMessage() noexcept
+    {
+        asio::async_read(*socket,
+                         asio::buffer(receiveBuffer.data(), incomingMessageSize),
+                         [this](asio::error_code const &err_code, size_t bytes_read_num) {
+                             if (err_code) {
+                                 OnLinkError("Failed to get message from master! Err: " + err_code.message());
+                                 return;
+                             }
+
+                             RestartMasterSilenceTimer();
+                             HandleMessageFromMaster(bytes_read_num);
+                             StartReadingMessageSize();
+                         });
+    }
+    void HandleMessageFromMaster(size_t message_size) noexcept
+    {
+        // parsed in place, command ingestion does not allocate
+        auto [parse_result, msg] = MessageFromMaster::Parse(ByteSpan{ receiveBuffer.data(), message_size });
+
+        if (parse_result == MessageFromMaster::ParseResult::Good and msg->IsSessionCommand()) {
+            HandleSessionCommand(*msg);
+            return;
+        }
+
+        if (immediateAutoResponse) {
+            console.Log("Answering \"Im Initializing\" to master!");
+            QueueForWrite(immediateAutoResponse->Serialize());
+            return;
+        }
+
+        if (parse_result != MessageFromMaster::ParseResult::Good) {
+            console.LogError("Master's message deserialization failed, err: " +
+                             std::to_string(ToUnderlying(parse_result)));
+            QueueForWrite(CommandStatus(CommandStatus::Answer::CommandNoAcknowledge).Serialize());
+            return;
+        }
+
+        // keepalive is answered right here, so it is not delayed by command being executed
+        if (msg->GetCommandID() == MessageFromMaster::Command::ID::DataLinkKeepAlive) {
+            QueueForWrite(TagIfNeeded(msg->GetRequestId(), KeepAlive().Serialize()));
+            return;
+        }
+
+        // io task must never block, master is informed that command was dropped
+        auto &commands_queue = msg->IsControlCommand() ? controlCommandsQ : fromMasterCommandsQ;
+        auto  answer         = commands_queue->SendImmediate(*msg) ? CommandStatus::Answer::CommandAcknowledge
+                                                                   : CommandStatus::Answer::CommandNoAcknowledge;
+        if (answer == CommandStatus::Answer::CommandNoAcknowledge)
+            console.LogError("Commands queue is full, command dropped!");
+        else
+            commandsPending->Give();
+
+        // tagged commands are acknowledged on reception, so master may keep many of them in flight
+        if (msg->IsTagged() or answer == CommandStatus::Answer::CommandNoAcknowledge)
+            QueueForWrite(TagIfNeeded(msg->GetRequestId(), CommandStatus(answer).Serialize()));
+    }
+
+    static std::vector<Byte> TagIfNeeded(RequestIdT request_id, std::vector<Byte> &&bytes) noexcept
+    {
+        if (request_id == MessageFromMaster::untaggedRequestId)
+            return std::move(bytes);
+
+        return TaggedMessage(request_id, ByteSpan{ bytes.data(), bytes.size() }).Serialize();
+    }
+
+    void HandleSessionCommand(MessageFromMaster const &msg) noexcept
+    {
+        if (msg.GetCommandID() == MessageFromMaster::Command::ID::SubscribeTelemetry) {
+            // datagrams go to the peer which subscribed, master is not necessarily the gateway
+            auto       err_code   = asio::error_code();
+            auto const subscriber = socket->remote_endpoint(err_code);
+            auto const answer     = err_code ? CommandStatus::Answer::CommandNoAcknowledge
+                                             : CommandStatus::Answer::CommandAcknowledge;
+
+            if (err_code)
+                console.LogError("Telemetry subscriber address unknown! Err: " + err_code.message());
+            else
+                telemetry.Subscribe(
+                  subscriber.address(), msg.cmd.subscribeTelemetry.port, msg.cmd.subscribeTelemetry.intervalMs);
+
+            QueueForWrite(TagIfNeeded(msg.GetRequestId(), CommandStatus(answer).Serialize()));
+            return;
+        }
+
+        auto const messages_received = msg.cmd.sessionPosition.messagesReceived;
+
+        if (msg.GetCommandID() == MessageFromMaster::Command::ID::AckResults) {
+            replayRing.Acknowledge(messages_received);
+            StartWrite();
+            return;
+        }
+
+        if (not awaitingResume) {
+            console.LogError("Unexpected session resume request");
+            return;
+        }
+
+        console.Log("Session resumed, master received " + std::to_string(messages_received) + " messages");
+        replayRing.Rewind(messages_received);
+        ContinueSession();
+    }
+    void ContinueSession() noexcept
+    {
+        awaitingResume = false;
+        resumeWaitTimer.cancel();
+        StartWrite();
+    }
+
+    void RestartMasterSilenceTimer() noexcept
+    {
+        masterSilenceTimer.expires_after(std::chrono::milliseconds(ProjCfg::Socket::MasterSilenceTimeoutMs));
+        masterSilenceTimer.async_wait([this](asio::error_code const &err_code) {
+            // restarted timer completes with operation_aborted
+            if (err_code)
+                return;
+
+            OnLinkError("Master is silent for more than " + std::to_string(ProjCfg::Socket::MasterSilenceTimeoutMs) +
+                        "ms");
+        });
+    }
+    /**
+     * @brief connection is reestablished in place, messages produced meanwhile are kept in replay ring
+     */
+    void OnLinkError(std::string &&description) noexcept
+    {
+        if (not linkIsUp)
+            return;
+
+        console.LogError("Link to master lost: " + description);
+
+        linkIsUp = false;
+        telemetry.CountLinkError();
+        CloseSocket();
+        masterSilenceTimer.cancel();
+        resumeWaitTimer.cancel();
+
+        reconnectBackoffMs          = ProjCfg::Socket::ReconnectBackoffInitialMs;
+        directReconnectAttemptsLeft = ProjCfg::Socket::DirectReconnectAttempts;
+        ScheduleReconnect();
+    }
+    void CloseSocket() noexcept
+    {
+        auto ignored_error = asio::error_code();
+        socket->shutdown(asio::socket_base::shutdown_type::shutdown_both, ignored_error);
+        socket->close(ignored_error);
+    }
+    void ScheduleReconnect() noexcept
+    {
+        reconnectTimer.expires_after(std::chrono::milliseconds(reconnectBackoffMs));
+        reconnectTimer.async_wait([this](asio::error_code const &err_code) {
+            if (err_code)
+                return;
+
+            StartReconnect();
+        });
+
+        reconnectBackoffMs = std::min(reconnectBackoffMs * 2, static_cast<int>(ProjCfg::Socket::ReconnectBackoffMaxMs));
+    }
+    void RetryReconnect(std::string &&description) noexcept
+    {
+        console.LogError("Reconnection attempt failed: " + description);
+        CloseSocket();
+        ScheduleReconnect();
+    }
+    /**
+     * @brief cached working port is tried directly first, after limited number of failed attempts working port is
+     * negotiated again through entry port, same as on startup
+     */
+    void StartReconnect() noexcept
+    {
+        if (cachedWorkingPort != std::nullopt and directReconnectAttemptsLeft > 0) {
+            directReconnectAttemptsLeft--;
+            ConnectToWorkingPort();
+            return;
+        }
+
+        auto entry_endpoint = asio::ip::tcp::endpoint(masterIP, ProjCfg::Socket::EntryPortNumber);
+
+        socket->async_connect(entry_endpoint, [this](asio::error_code const &err_code) {
+            if (err_code) {
+                RetryReconnect("entry port connection: " + err_code.message());
+                return;
             }
 
+            asio::async_read(*socket,
+                             asio::buffer(&negotiatedPort, sizeof(negotiatedPort)),
+                             [this](asio::error_code const &err_code, size_t) {
+                                 if (err_code) {
+                                     RetryReconnect("working port reception: " + err_code.message());
+                                     return;
+                                 }
+
+                                 ConfirmWorkingPort();
+                             });
+        });
+    }
+    void ConfirmWorkingPort() noexcept
+    {
+        confirmationBuffer = { MessageType::Confirmation, 1 };
+
+        asio::async_write(*socket, asio::buffer(confirmationBuffer), [this](asio::error_code const &err_code, size_t) {
             if (err_code) {
-                console.OnFatalErrorTermination("Failed to get message from master! Err: " + err_code.message());
+                RetryReconnect("working port confirmation: " + err_code.message());
+                return;
             }
 
-            try {
-                if (immediateAutoResponse) {
-                    console.Log("Answering \"Im Initializing\" to master!");
-                    toMasterSB->Send(immediateAutoResponse->Serialize(), pdMS_TO_TICKS(100));
-                    continue;
-                }
+            CloseSocket();
+            currentSocketPort = static_cast<PortNumT>(negotiatedPort);
+            cachedWorkingPort = currentSocketPort;
+            endpoint          = std::make_shared<asio::ip::tcp::endpoint>(masterIP, currentSocketPort);
+
+            ConnectToWorkingPort();
+        });
+    }
+    void ConnectToWorkingPort() noexcept
+    {
+        socket->async_connect(*endpoint, [this](asio::error_code const &err_code) {
+            if (err_code) {
+                RetryReconnect("working port " + std::to_string(currentSocketPort) +
+                               " connection: " + err_code.message());
+                return;
+            }
+
+            directReconnectAttemptsLeft = ProjCfg::Socket::DirectReconnectAttempts;
+            OnReconnected();
+        });
+    }
+    /**
+     * @brief session hello goes first, then master has limited time to tell how many messages it received before
+     * sending continues
+     */
+    void OnReconnected() noexcept
+    {
+        console.Log("Reconnected to master! Port: " + std::to_string(currentSocketPort));
 
-                auto msg = MessageFromMaster(std::vector<Byte>(main_buffer.begin(), main_buffer.end()));
-                console.Log("New message from master obtained! ID: " + std::to_string(ToUnderlying(msg.GetCommandID())));
-                fromMasterCommandsQ->Send(msg);
-            } catch (const std::invalid_argument &exception) {
-                console.LogError("Invalid argument exception during master's message deserializatio! Err: " +
-                                 std::string(exception.what()));
+        auto err_code = asio::error_code();
+        socket->set_option(asio::ip::tcp::no_delay(true), err_code);
+        socket->set_option(asio::socket_base::keep_alive(true), err_code);
 
-            } catch (std::system_error &e) {
-                console.LogError("System Error during master's message deserialization! Err: " + std::string(e.what()));
-            } catch (...) {
-                console.LogError("Unknown error deserializing master's message");
-                continue;
+        linkIsUp        = true;
+        awaitingResume  = true;
+        writeInProgress = true;
+        PrepareSessionHello();
+
+        asio::async_write(*socket, SessionHelloBuffers(), [this](asio::error_code const &err_code, size_t) {
+            writeInProgress = false;
+
+            if (err_code) {
+                OnLinkError("Session hello write failed: " + err_code.message());
+                return;
             }
-        }
+
+            resumeWaitTimer.expires_after(std::chrono::milliseconds(ProjCfg::Socket::ResumeWaitMs));
+            resumeWaitTimer.async_wait([this](asio::error_code const &err_code) {
+                if (err_code or not awaitingResume)
+                    return;
+
+                console.Log("Master did not resume session, sending continues without replay");
+                ContinueSession();
+            });
+        });
+
+        StartReadingMessageSize();
+        RestartMasterSilenceTimer();
+    }
+    void PrepareSessionHello() noexcept
+    {
+        auto hello = SessionHello(sessionToken, replayRing.OldestPosition(), replayRing.EndPosition());
+
+        sessionHello     = hello.Serialize();
+        sessionHelloSize = sessionHello.size();
+    }
+    /**
+     * @brief session hello with its length prefix
+     */
+    std::array<asio::const_buffer, 2> SessionHelloBuffers() const noexcept
+    {
+        return { asio::buffer(&sessionHelloSize, sizeof(sessionHelloSize)), asio::buffer(sessionHello) };
     }
 
     std::optional<PortNumT> ObtainWorkingPortNumberBlocking() noexcept
     {
-        auto err_code = asio::error_code();
+        auto err_code   = asio::error_code();
+        auto backoff_ms = static_cast<int>(ProjCfg::Socket::ReconnectBackoffInitialMs);
 
         while (true) {
             try {
@@ -189,7 +775,8 @@ class Communicator {
 
             if (err_code) {
                 console.LogError("Error during standard port connection: " + err_code.message());
-                Task::DelayMs(1000);
+                Task::DelayMs(backoff_ms);
+                backoff_ms = std::min(backoff_ms * 2, static_cast<int>(ProjCfg::Socket::ReconnectBackoffMaxMs));
                 socket->close();
                 continue;
             }
@@ -260,12 +847,44 @@ class Communicator {
     std::shared_ptr<asio::io_context>        io_context;
     std::shared_ptr<asio::ip::tcp::socket>   socket;
     std::shared_ptr<asio::ip::tcp::endpoint> endpoint;
-    std::shared_ptr<ByteStreamBuffer>        toMasterSB;
+    asio::steady_timer                       masterSilenceTimer;
+    asio::steady_timer                       reconnectTimer;
+    asio::steady_timer                       resumeWaitTimer;
+    asio::ip::tcp::acceptor                  observersAcceptor;
+    asio::ip::tcp::socket                    acceptedObserverSocket;
+    TelemetryStream                          telemetry;
+    std::shared_ptr<ToMasterFrames>          toMasterFrames;
 
     std::shared_ptr<FromMasterQ> fromMasterCommandsQ;
-
-    Task writeTask;
-    Task readTask;
+    std::shared_ptr<FromMasterQ> controlCommandsQ;
+    std::shared_ptr<Semaphore>   commandsPending;
+
+    Task ioTask;
+
+    std::deque<std::vector<Byte>>   writeQueue;
+    std::vector<asio::const_buffer> writeBuffers;
+    bool                            writeInProgress{ false };
+    std::atomic<bool>               writerNotificationPending{ false };
+    Mutex                           chunkedSendMutex;
+    MessageChunk::StreamIdT         nextChunkStreamId{ 0 };
+    ReplayBuffer                    replayRing;
+
+    std::array<std::unique_ptr<Observer>, ProjCfg::Socket::MaxObservers> observers;
+
+    uint32_t            sessionToken{ esp_random() };
+    std::vector<Byte>   sessionHello;
+    size_t              sessionHelloSize{};
+    bool                linkIsUp{ false };
+    bool                awaitingResume{ false };
+    int                 reconnectBackoffMs{ ProjCfg::Socket::ReconnectBackoffInitialMs };
+    int                 negotiatedPort{};
+    int                 directReconnectAttemptsLeft{ ProjCfg::Socket::DirectReconnectAttempts };
+
+    std::optional<PortNumT> cachedWorkingPort;
+    std::array<Byte, 2> confirmationBuffer{};
+
+    int                                                incomingMessageSize{};
+    std::array<Byte, ProjCfg::Socket::ReceiveBufferSize> receiveBuffer{};
 
     std::optional<CommandStatus> immediateAutoResponse{ CommandStatus(CommandStatus::Answer::DeviceIsInitializing) };
 
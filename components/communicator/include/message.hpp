@@ -3,13 +3,32 @@
 #include <cstdlib>
 #include <array>
 #include <variant>
+#include <optional>
+#include <utility>
+#include <type_traits>
 
 #include "vector_algorithms.hpp"
 #include "utilities.hpp"
+#include "byte_span.hpp"
 
+/**
+ * @brief command from master, fixed size and trivially copyable so it can be queued without allocation. Parsed
+ * directly from received bytes by Parse(), errors are reported by value.
+ */
 class MessageFromMaster {
   public:
-    using Byte = uint8_t;
+    using Byte       = uint8_t;
+    using RequestIdT = uint16_t;
+
+    constexpr static RequestIdT untaggedRequestId = 0;
+
+    enum class ParseResult : Byte {
+        Good = 0,
+        Empty,
+        TooShort,
+        InvalidArgument,
+        UnknownCommand
+    };
 
     union Command {
         enum class ID : Byte {
@@ -30,99 +49,391 @@ class MessageFromMaster {
             DataLinkKeepAlive,
             DisableOutput,
             Dummy,
+            MeasureAllHiRes,
+            Tagged,
+            CancelScan,
+            GetStatus,
+            PauseScan,
+            ResumeScan,
+            ResumeSession,
+            AckResults,
+            SubscribeTelemetry,
+            CheckPinsBatch,
+            ScanBoards,
+            MonitorBoards,
+            WiggleTest,
+            SetOversampling,
+            SetCacheWindow,
+            MeasureAllDelta,
+            ScanNetlist,
             Unknown
         };
-        using Bytes    = std::vector<Byte>;
-        using Iterator = std::vector<Byte>::const_iterator;
 
         struct MeasureAll { };
         struct SetVoltageLevel {
-            SetVoltageLevel(Byte byte)
-            {
-                if (byte > ToUnderlying(Level::High))
-                    throw std::errc::invalid_argument;
-
-                lvl = static_cast<Level>(byte);
-            }
             enum class Level : Byte {
                 Low = 0,
                 High
             };
 
-            Level lvl{ Level::Low };
+            static ParseResult Parse(ByteSpan args, SetVoltageLevel &into) noexcept
+            {
+                if (args.size() < 1)
+                    return ParseResult::TooShort;
+                if (args[0] > ToUnderlying(Level::High))
+                    return ParseResult::InvalidArgument;
+
+                into.lvl = static_cast<Level>(args[0]);
+                return ParseResult::Good;
+            }
+
+            Level lvl;
         };
         struct SetVoltageAtPin {
-            SetVoltageAtPin(const Bytes &bytes)
-              : boardAffinity{ bytes.at(1) }
-              , pinNumber{ bytes.at(2) }
-            { }
+            static ParseResult Parse(ByteSpan args, SetVoltageAtPin &into) noexcept
+            {
+                if (args.size() < 2)
+                    return ParseResult::TooShort;
+
+                into.boardAffinity = args[0];
+                into.pinNumber     = args[1];
+                return ParseResult::Good;
+            }
 
             Byte boardAffinity;
             Byte pinNumber;
         };
         struct GetBoardsInfo {
-            GetBoardsInfo(Iterator it)
+            static ParseResult Parse(ByteSpan args, GetBoardsInfo &into) noexcept
             {
-                if (*it == 1)
-                    performRescan = true;
-                else
-                    performRescan = false;
+                if (args.size() < 1)
+                    return ParseResult::TooShort;
+
+                into.performRescan = args[0] == 1;
+                return ParseResult::Good;
             }
 
-            bool performRescan = false;
+            bool performRescan;
         };
         struct CheckConnections {
-            CheckConnections(std::vector<Byte>::const_iterator byte_it)
+            static ParseResult Parse(ByteSpan args, CheckConnections &into) noexcept
             {
-                if (*byte_it == CHECK_ALL) {
-                    measureAll = true;
-                    return;
-                }
-                if (*byte_it > ADDRESSES_ALLOWED_INCLUSIVE.second or *byte_it < ADDRESSES_ALLOWED_INCLUSIVE.first) {
-                    throw std::invalid_argument("board address is not inside allowed addresses : " +
-                                                std::to_string(*byte_it));
+                if (args.size() < 1)
+                    return ParseResult::TooShort;
+
+                if (args[0] == CHECK_ALL) {
+                    into.measureAll = true;
+                    return ParseResult::Good;
                 }
-                boardAffinity = *byte_it++;
-                if (*byte_it > MAX_PIN)
-                    throw std::invalid_argument("pin number is higher than allowed: " + std::to_string(*byte_it));
 
-                pinNumber = *byte_it;
+                if (args.size() < 2)
+                    return ParseResult::TooShort;
+                if (args[0] > ADDRESSES_ALLOWED_INCLUSIVE.second or args[0] < ADDRESSES_ALLOWED_INCLUSIVE.first)
+                    return ParseResult::InvalidArgument;
+                if (args[1] > MAX_PIN)
+                    return ParseResult::InvalidArgument;
+
+                into.measureAll    = false;
+                into.boardAffinity = args[0];
+                into.pinNumber     = args[1];
+                return ParseResult::Good;
             }
+
             Byte                  boardAffinity;
             Byte                  pinNumber;
-            bool                  measureAll                  = false;
+            bool                  measureAll;
             constexpr static Byte CHECK_ALL                   = 255;
             constexpr static Byte MAX_PIN                     = Board::pinCount - 1;
             constexpr static auto ADDRESSES_ALLOWED_INCLUSIVE = Board::ADDRESSES_ALLOWED_INCLUSIVE;
         };
         struct KeepAliveMessage { };
         struct EnableOutputForPin {
-            EnableOutputForPin(Iterator it)
-              : pinAffinityAndId{ *it++, *it }
-            { }
+            static ParseResult Parse(ByteSpan args, EnableOutputForPin &into) noexcept
+            {
+                if (args.size() < 2)
+                    return ParseResult::TooShort;
+
+                into.pinAffinityAndId = Board::PinAffinityAndId{ args[0], args[1] };
+                return ParseResult::Good;
+            }
 
             Board::PinAffinityAndId pinAffinityAndId;
         };
         struct DisableOutput { };
         struct Dummy { };
+        /**
+         * @brief number of messages master received from device since session start
+         */
+        struct SessionPosition {
+            static ParseResult Parse(ByteSpan args, SessionPosition &into) noexcept
+            {
+                if (args.size() < sizeof(uint32_t))
+                    return ParseResult::TooShort;
 
-        Command(std::vector<Byte> const &bytes)
-        {
-            auto msg_id = bytes.at(0);
-
-            switch (static_cast<ID>(msg_id)) {
-            case ID::MeasureAll: measureAll = MeasureAll(); break;
-            case ID::SetOutputVoltageLevel: setVLvl = SetVoltageLevel{ bytes.at(1) }; break;
-            case ID::GetBoards: getBoards = GetBoardsInfo{bytes.cbegin() + 1}; break;
-            case ID::DataLinkKeepAlive: keepAlive = KeepAliveMessage{}; break;
-            case ID::CheckConnections: checkConnections = CheckConnections{ bytes.cbegin() + 1 }; break;
-            case ID::EnableOutputForPin: enableOutputForPin = EnableOutputForPin{ bytes.cbegin() + 1 }; break;
-            case ID::DisableOutput: disableOutput = DisableOutput{}; break;
-            case ID::Dummy: dummy = Dummy{}; break;
-
-            default: throw std::system_error(std::error_code(), "Unimplemented command id: " + std::to_string(msg_id));
+                into.messagesReceived = static_cast<uint32_t>(args[0]) | (static_cast<uint32_t>(args[1]) << 8) |
+                                        (static_cast<uint32_t>(args[2]) << 16) | (static_cast<uint32_t>(args[3]) << 24);
+                return ParseResult::Good;
+            }
+
+            uint32_t messagesReceived;
+        };
+        /**
+         * @brief [UDP port lo][UDP port hi][interval ms lo][interval ms hi], port 0 stops telemetry
+         */
+        struct SubscribeTelemetry {
+            static ParseResult Parse(ByteSpan args, SubscribeTelemetry &into) noexcept
+            {
+                if (args.size() < 4)
+                    return ParseResult::TooShort;
+
+                into.port       = static_cast<uint16_t>(args[0] | (args[1] << 8));
+                into.intervalMs = static_cast<uint16_t>(args[2] | (args[3] << 8));
+                return ParseResult::Good;
+            }
+
+            uint16_t port;
+            uint16_t intervalMs;
+        };
+        /**
+         * @brief [boards number][board address][pins mask, 4 bytes little endian]... up to maxBoards entries, all
+         * masked pins are checked as one scan. Entries are kept as received and decoded on access, so batch is not
+         * larger than other commands in queue slots.
+         */
+        struct CheckPinsBatch {
+            using PinsMaskT = uint32_t;
+            static_assert(Board::pinCount <= sizeof(PinsMaskT) * 8, "every pin of board must fit into mask");
+
+            constexpr static Byte   maxBoards                   = 12;
+            constexpr static size_t entrySize                   = 1 + sizeof(PinsMaskT);
+            constexpr static auto   ADDRESSES_ALLOWED_INCLUSIVE = Board::ADDRESSES_ALLOWED_INCLUSIVE;
+
+            struct BoardPins {
+                Byte      boardAddress;
+                PinsMaskT pinsMask;
             };
-        }
+
+            static ParseResult Parse(ByteSpan args, CheckPinsBatch &into) noexcept
+            {
+                if (args.size() < 1)
+                    return ParseResult::TooShort;
+                if (args[0] == 0 or args[0] > maxBoards)
+                    return ParseResult::InvalidArgument;
+
+                into.boardsNumber = args[0];
+                if (args.size() < 1 + into.boardsNumber * entrySize)
+                    return ParseResult::TooShort;
+
+                for (size_t idx = 0; idx < into.boardsNumber; idx++) {
+                    auto entry = args.subspan(1 + idx * entrySize);
+
+                    if (entry[0] > ADDRESSES_ALLOWED_INCLUSIVE.second or entry[0] < ADDRESSES_ALLOWED_INCLUSIVE.first)
+                        return ParseResult::InvalidArgument;
+
+                }
+
+                std::copy(args.begin() + 1, args.begin() + 1 + into.boardsNumber * entrySize, into.entries.begin());
+                return ParseResult::Good;
+            }
+
+            [[nodiscard]] BoardPins Entry(size_t idx) const noexcept
+            {
+                auto const *entry = entries.data() + idx * entrySize;
+
+                return BoardPins{ entry[0],
+                                  static_cast<PinsMaskT>(entry[1]) | (static_cast<PinsMaskT>(entry[2]) << 8) |
+                                    (static_cast<PinsMaskT>(entry[3]) << 16) |
+                                    (static_cast<PinsMaskT>(entry[4]) << 24) };
+            }
+
+            Byte                                    boardsNumber;
+            std::array<Byte, maxBoards * entrySize> entries;
+        };
+        /**
+         * @brief [drive boards number][read boards number], then [board address][first pin][last pin] of every drive
+         * board, then address of every read board. Pins from first to last inclusive of drive boards are driven, only
+         * read boards are read. No drive boards means all pins of all boards are driven, no read boards means all
+         * boards are read.
+         */
+        struct ScanBoards {
+            struct PinRange {
+                Byte boardAddress;
+                Byte firstPin;
+                Byte lastPin;
+            };
+
+            constexpr static Byte   maxBoards                   = 16;
+            constexpr static size_t driveEntrySize              = 3;
+            constexpr static Byte   MAX_PIN                     = Board::pinCount - 1;
+            constexpr static auto   ADDRESSES_ALLOWED_INCLUSIVE = Board::ADDRESSES_ALLOWED_INCLUSIVE;
+
+            static ParseResult Parse(ByteSpan args, ScanBoards &into) noexcept
+            {
+                if (args.size() < 2)
+                    return ParseResult::TooShort;
+                if (args[0] > maxBoards or args[1] > maxBoards)
+                    return ParseResult::InvalidArgument;
+
+                into.driveBoardsNumber = args[0];
+                into.readBoardsNumber  = args[1];
+                if (args.size() < 2 + into.driveBoardsNumber * driveEntrySize + into.readBoardsNumber)
+                    return ParseResult::TooShort;
+
+                for (size_t idx = 0; idx < into.driveBoardsNumber; idx++) {
+                    auto entry = args.subspan(2 + idx * driveEntrySize);
+
+                    if (not AddressIsAllowed(entry[0]) or entry[1] > entry[2] or entry[2] > MAX_PIN)
+                        return ParseResult::InvalidArgument;
+
+                    into.driveBoards[idx] = PinRange{ entry[0], entry[1], entry[2] };
+                }
+
+                auto read_addresses = args.subspan(2 + into.driveBoardsNumber * driveEntrySize);
+                for (size_t idx = 0; idx < into.readBoardsNumber; idx++) {
+                    if (not AddressIsAllowed(read_addresses[idx]))
+                        return ParseResult::InvalidArgument;
+
+                    into.readBoards[idx] = read_addresses[idx];
+                }
+
+                return ParseResult::Good;
+            }
+            static bool AddressIsAllowed(Byte address) noexcept
+            {
+                return address >= ADDRESSES_ALLOWED_INCLUSIVE.first and address <= ADDRESSES_ALLOWED_INCLUSIVE.second;
+            }
+
+            Byte                            driveBoardsNumber;
+            Byte                            readBoardsNumber;
+            std::array<PinRange, maxBoards> driveBoards;
+            std::array<Byte, maxBoards>     readBoards;
+        };
+        /**
+         * @brief [driven pins number][read boards number][summary period ms lo][summary period ms hi], then
+         * [board][pin] of every driven pin, then address of every read board, no read boards means all boards are read
+         */
+        struct WiggleTest {
+            constexpr static Byte   maxDrivenPins = 8;
+            constexpr static Byte   maxReadBoards = 16;
+            constexpr static size_t headerSize    = 4;
+            constexpr static Byte   MAX_PIN       = Board::pinCount - 1;
+
+            static ParseResult Parse(ByteSpan args, WiggleTest &into) noexcept
+            {
+                if (args.size() < headerSize)
+                    return ParseResult::TooShort;
+                if (args[0] == 0 or args[0] > maxDrivenPins or args[1] > maxReadBoards)
+                    return ParseResult::InvalidArgument;
+
+                into.drivenPinsNumber = args[0];
+                into.readBoardsNumber = args[1];
+                into.summaryPeriodMs  = static_cast<uint16_t>(args[2] | (args[3] << 8));
+                if (args.size() < headerSize + into.drivenPinsNumber * 2 + into.readBoardsNumber)
+                    return ParseResult::TooShort;
+
+                for (size_t idx = 0; idx < into.drivenPinsNumber; idx++) {
+                    auto entry = args.subspan(headerSize + idx * 2);
+
+                    if (not ScanBoards::AddressIsAllowed(entry[0]) or entry[1] > MAX_PIN)
+                        return ParseResult::InvalidArgument;
+
+                    into.drivenPins[idx] = Board::PinAffinityAndId{ entry[0], entry[1] };
+                }
+
+                auto read_addresses = args.subspan(headerSize + into.drivenPinsNumber * 2);
+                for (size_t idx = 0; idx < into.readBoardsNumber; idx++) {
+                    if (not ScanBoards::AddressIsAllowed(read_addresses[idx]))
+                        return ParseResult::InvalidArgument;
+
+                    into.readBoards[idx] = read_addresses[idx];
+                }
+
+                return ParseResult::Good;
+            }
+
+            Byte                                                drivenPinsNumber;
+            Byte                                                readBoardsNumber;
+            uint16_t                                            summaryPeriodMs;
+            std::array<Board::PinAffinityAndId, maxDrivenPins> drivenPins;
+            std::array<Byte, maxReadBoards>                     readBoards;
+        };
+        /**
+         * @brief [max samples][confidence steps][decision level][clear level], applies to scans started later. Max
+         * samples of 1 disables oversampling.
+         */
+        struct SetOversampling {
+            static ParseResult Parse(ByteSpan args, SetOversampling &into) noexcept
+            {
+                if (args.size() < 4)
+                    return ParseResult::TooShort;
+                if (args[0] == 0 or args[1] == 0 or args[2] == 0 or args[3] <= args[2])
+                    return ParseResult::InvalidArgument;
+
+                into.maxSamples      = args[0];
+                into.confidenceSteps = args[1];
+                into.decisionLevel   = args[2];
+                into.clearLevel      = args[3];
+                return ParseResult::Good;
+            }
+
+            Byte maxSamples;
+            Byte confidenceSteps;
+            Byte decisionLevel;
+            Byte clearLevel;
+        };
+        /**
+         * @brief [freshness window ms lo][freshness window ms hi], 0 disables acquisition cache
+         */
+        struct SetCacheWindow {
+            static ParseResult Parse(ByteSpan args, SetCacheWindow &into) noexcept
+            {
+                if (args.size() < 2)
+                    return ParseResult::TooShort;
+
+                into.windowMs = static_cast<uint16_t>(args[0] | (args[1] << 8));
+                return ParseResult::Good;
+            }
+
+            uint16_t windowMs;
+        };
+        /**
+         * @brief [acknowledged frame lo][acknowledged frame hi][deadband], acknowledged frame is the last delta frame
+         * master has applied, AllBoardsVoltagesDelta::keyframeReference if it has none
+         */
+        struct MeasureAllDelta {
+            static ParseResult Parse(ByteSpan args, MeasureAllDelta &into) noexcept
+            {
+                if (args.size() < 3)
+                    return ParseResult::TooShort;
+
+                into.acknowledgedFrame = static_cast<uint16_t>(args[0] | (args[1] << 8));
+                into.deadband          = args[2];
+                return ParseResult::Good;
+            }
+
+            uint16_t acknowledgedFrame;
+            Byte     deadband;
+        };
+        /**
+         * @brief [flags], bit 0 requests voltage of every connection in netlist
+         */
+        struct ScanNetlist {
+            static ParseResult Parse(ByteSpan args, ScanNetlist &into) noexcept
+            {
+                if (args.size() < 1)
+                    return ParseResult::TooShort;
+
+                into.withVoltages = (args[0] & withVoltagesFlag) != 0;
+                return ParseResult::Good;
+            }
+
+            constexpr static Byte withVoltagesFlag = 0x01;
+
+            bool withVoltages;
+        };
+
+        Command() noexcept
+          : dummy{}
+        { }
 
         MeasureAll         measureAll;
         SetVoltageLevel    setVLvl;
@@ -132,20 +443,118 @@ class MessageFromMaster {
         EnableOutputForPin enableOutputForPin;
         DisableOutput      disableOutput;
         Dummy              dummy;
+        SessionPosition    sessionPosition;
+        SubscribeTelemetry subscribeTelemetry;
+        CheckPinsBatch     checkPinsBatch;
+        ScanBoards         scanBoards;
+        WiggleTest         wiggleTest;
+        SetOversampling    setOversampling;
+        SetCacheWindow     setCacheWindow;
+        MeasureAllDelta    measureAllDelta;
+        ScanNetlist        scanNetlist;
+
+        static_assert(sizeof(CheckPinsBatch) <= sizeof(ScanBoards), "batch must not enlarge queue slots");
     };
 
-    MessageFromMaster(const std::vector<Byte> &bytes)
-      : cmd{ bytes }
-      , commandID{ bytes.at(0) }
-    { }
+    /**
+     * @brief parses command from exactly the bytes of one message, first byte is command id. Tagged command is
+     * [Tagged][requestId lo][requestId hi][command...], non zero request id is echoed in every response to it.
+     */
+    static std::pair<ParseResult, std::optional<MessageFromMaster>> Parse(ByteSpan bytes) noexcept
+    {
+        if (bytes.empty())
+            return { ParseResult::Empty, std::nullopt };
+
+        auto msg = MessageFromMaster{};
+
+        if (static_cast<Command::ID>(bytes[0]) == Command::ID::Tagged) {
+            if (bytes.size() < taggedHeaderSize + 1)
+                return { ParseResult::TooShort, std::nullopt };
+
+            msg.requestId = static_cast<RequestIdT>(bytes[1] | (bytes[2] << 8));
+            if (msg.requestId == untaggedRequestId or static_cast<Command::ID>(bytes[3]) == Command::ID::Tagged)
+                return { ParseResult::InvalidArgument, std::nullopt };
+
+            bytes = bytes.subspan(taggedHeaderSize);
+        }
+
+        auto result = ParseCommand(bytes, msg);
+        if (result != ParseResult::Good)
+            return { result, std::nullopt };
+
+        return { ParseResult::Good, msg };
+    }
 
     Command::ID GetCommandID() const noexcept { return commandID; }
+    RequestIdT  GetRequestId() const noexcept { return requestId; }
+    /**
+     * @brief session commands are handled by socket io task itself
+     */
+    bool IsSessionCommand() const noexcept
+    {
+        return commandID == Command::ID::ResumeSession or commandID == Command::ID::AckResults or
+               commandID == Command::ID::SubscribeTelemetry;
+    }
+    /**
+     * @brief control commands bypass commands queue and are executed between steps of running scan. ResumeScan runs
+     * the scan itself, so it goes through commands queue.
+     */
+    bool IsControlCommand() const noexcept
+    {
+        return commandID == Command::ID::DisableOutput or commandID == Command::ID::CancelScan or
+               commandID == Command::ID::GetStatus or commandID == Command::ID::PauseScan;
+    }
+    bool        IsTagged() const noexcept { return requestId != untaggedRequestId; }
 
     Command     cmd;
-    Command::ID commandID{};
+    Command::ID commandID{ Command::ID::Unknown };
+    RequestIdT  requestId{ untaggedRequestId };
 
   private:
+    MessageFromMaster() = default;
+
+    static ParseResult ParseCommand(ByteSpan bytes, MessageFromMaster &msg) noexcept
+    {
+        msg.commandID = static_cast<Command::ID>(bytes[0]);
+        auto args     = bytes.subspan(1);
+
+        switch (msg.commandID) {
+        case Command::ID::MeasureAll: msg.cmd.measureAll = Command::MeasureAll{}; break;
+        case Command::ID::MeasureAllHiRes: msg.cmd.measureAll = Command::MeasureAll{}; break;
+        case Command::ID::SetOutputVoltageLevel: return Command::SetVoltageLevel::Parse(args, msg.cmd.setVLvl);
+        case Command::ID::GetBoards: return Command::GetBoardsInfo::Parse(args, msg.cmd.getBoards);
+        case Command::ID::DataLinkKeepAlive: msg.cmd.keepAlive = Command::KeepAliveMessage{}; break;
+        case Command::ID::CheckConnections: return Command::CheckConnections::Parse(args, msg.cmd.checkConnections);
+        case Command::ID::EnableOutputForPin:
+            return Command::EnableOutputForPin::Parse(args, msg.cmd.enableOutputForPin);
+        case Command::ID::DisableOutput: msg.cmd.disableOutput = Command::DisableOutput{}; break;
+        case Command::ID::Dummy: msg.cmd.dummy = Command::Dummy{}; break;
+        case Command::ID::CancelScan: msg.cmd.dummy = Command::Dummy{}; break;
+        case Command::ID::GetStatus: msg.cmd.dummy = Command::Dummy{}; break;
+        case Command::ID::PauseScan: msg.cmd.dummy = Command::Dummy{}; break;
+        case Command::ID::ResumeScan: msg.cmd.dummy = Command::Dummy{}; break;
+        case Command::ID::ResumeSession: return Command::SessionPosition::Parse(args, msg.cmd.sessionPosition);
+        case Command::ID::AckResults: return Command::SessionPosition::Parse(args, msg.cmd.sessionPosition);
+        case Command::ID::SubscribeTelemetry:
+            return Command::SubscribeTelemetry::Parse(args, msg.cmd.subscribeTelemetry);
+        case Command::ID::CheckPinsBatch: return Command::CheckPinsBatch::Parse(args, msg.cmd.checkPinsBatch);
+        case Command::ID::ScanBoards: return Command::ScanBoards::Parse(args, msg.cmd.scanBoards);
+        case Command::ID::MonitorBoards: return Command::ScanBoards::Parse(args, msg.cmd.scanBoards);
+        case Command::ID::WiggleTest: return Command::WiggleTest::Parse(args, msg.cmd.wiggleTest);
+        case Command::ID::SetOversampling: return Command::SetOversampling::Parse(args, msg.cmd.setOversampling);
+        case Command::ID::SetCacheWindow: return Command::SetCacheWindow::Parse(args, msg.cmd.setCacheWindow);
+        case Command::ID::MeasureAllDelta: return Command::MeasureAllDelta::Parse(args, msg.cmd.measureAllDelta);
+        case Command::ID::ScanNetlist: return Command::ScanNetlist::Parse(args, msg.cmd.scanNetlist);
+
+        default: return ParseResult::UnknownCommand;
+        }
+
+        return ParseResult::Good;
+    }
+
+    auto constexpr static taggedHeaderSize = 3;
 };
+static_assert(std::is_trivially_copyable_v<MessageFromMaster>, "commands are passed through memcpy based queue");
 
 class MessageToMaster {
   public:
@@ -281,6 +690,11 @@ class AllBoardsVoltages final : MessageToMaster {
         }
     }
 
+    [[nodiscard]] std::vector<Board::OneBoardVoltages> const &GetBoardsVoltages() const noexcept
+    {
+        return boardsVoltages;
+    }
+
     std::vector<Byte> Serialize() noexcept override
     {
         std::vector<Byte> v;
@@ -308,6 +722,42 @@ class AllBoardsVoltages final : MessageToMaster {
     std::vector<Board::OneBoardVoltages> boardsVoltages;
 };
 
+class AllBoardsVoltagesHiRes final : MessageToMaster {
+  public:
+    struct OneBoardVoltagesHiRes {
+        Board::AddressT        boardAddress;
+        Board::AllPinsVoltages pinsVoltages;
+    };
+
+    explicit AllBoardsVoltagesHiRes(std::vector<OneBoardVoltagesHiRes> &&boards_voltages) noexcept
+      : boardsVoltages{ std::move(boards_voltages) }
+    { }
+
+    /**
+     * @brief voltages are ordered by logic pin number and packed with Board::PackHiResVoltages
+     */
+    std::vector<Byte> Serialize() noexcept override
+    {
+        std::vector<Byte> v;
+        v.reserve(sizeof(MSG_ID) + ONE_BOARD_VOLTAGES_SIZE_BYTES * boardsVoltages.size());
+        v.push_back(MSG_ID);
+
+        for (auto const &boardVoltages : boardsVoltages) {
+            v.push_back(boardVoltages.boardAddress);
+
+            auto packed_voltages = Board::PackHiResVoltages(boardVoltages.pinsVoltages);
+            v.insert(v.end(), packed_voltages.begin(), packed_voltages.end());
+        }
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte MSG_ID                        = 57;
+    constexpr static auto ONE_BOARD_VOLTAGES_SIZE_BYTES = 1 + sizeof(Board::AllPinsVoltagesPacked);
+    std::vector<OneBoardVoltagesHiRes> boardsVoltages;
+};
+
 // class Status final : MessageToMaster {
 //   public:
 //     enum class StatusValue : Byte {
@@ -367,4 +817,573 @@ class KeepAlive final : MessageToMaster {
 
   private:
     constexpr static Byte MSG_ID = 55;
+};
+
+/**
+ * @brief first message on every connection, not counted as session message:
+ * [id][session token, 4 bytes][oldest replayable message number, 4 bytes][next message number, 4 bytes].
+ * Token is constant until device restarts, master which sees known token resumes the session with ResumeSession.
+ */
+class SessionHello final : MessageToMaster {
+  public:
+    SessionHello(uint32_t session_token, uint32_t oldest_replayable, uint32_t next_message) noexcept
+      : sessionToken{ session_token }
+      , oldestReplayable{ oldest_replayable }
+      , nextMessage{ next_message }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(sizeof(MSG_ID) + 3 * sizeof(uint32_t));
+
+        v.push_back(MSG_ID);
+        for (auto const value : { sessionToken, oldestReplayable, nextMessage }) {
+            for (size_t byte_idx = 0; byte_idx < sizeof(value); byte_idx++)
+                v.push_back(static_cast<Byte>(value >> (8 * byte_idx)));
+        }
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte MSG_ID = 61;
+    uint32_t              sessionToken;
+    uint32_t              oldestReplayable;
+    uint32_t              nextMessage;
+};
+
+/**
+ * @brief answer to GetStatus: [id][state][scan requestId lo][scan requestId hi][board][pin][pins done lo][pins done hi]
+ */
+class DeviceStatus final : MessageToMaster {
+  public:
+    using RequestIdT = MessageFromMaster::RequestIdT;
+
+    enum class State : Byte {
+        Idle = 0,
+        Scanning,
+        Paused
+    };
+
+    DeviceStatus(State      device_state,
+                 RequestIdT scan_request_id = MessageFromMaster::untaggedRequestId,
+                 Byte       board_address   = 0,
+                 Byte       pin_number      = 0,
+                 uint16_t   pins_completed  = 0) noexcept
+      : state{ device_state }
+      , scanRequestId{ scan_request_id }
+      , boardAddress{ board_address }
+      , pin{ pin_number }
+      , pinsCompleted{ pins_completed }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        return { MSG_ID,
+                 ToUnderlying(state),
+                 static_cast<Byte>(scanRequestId & 0xff),
+                 static_cast<Byte>(scanRequestId >> 8),
+                 boardAddress,
+                 pin,
+                 static_cast<Byte>(pinsCompleted & 0xff),
+                 static_cast<Byte>(pinsCompleted >> 8) };
+    }
+
+  private:
+    constexpr static Byte MSG_ID = 60;
+    State                 state;
+    RequestIdT            scanRequestId;
+    Byte                  boardAddress;
+    Byte                  pin;
+    uint16_t              pinsCompleted;
+};
+
+class BoardsSetChanged final : MessageToMaster {
+  public:
+    using AddressT = Board::AddressT;
+
+    BoardsSetChanged(std::vector<AddressT> &&added_boards, std::vector<AddressT> &&removed_boards) noexcept
+      : addedBoards{ std::move(added_boards) }
+      , removedBoards{ std::move(removed_boards) }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(sizeof(MSG_ID) + 2 + addedBoards.size() + removedBoards.size());
+
+        v.push_back(MSG_ID);
+        v.push_back(static_cast<Byte>(addedBoards.size()));
+        v.insert(v.end(), addedBoards.begin(), addedBoards.end());
+        v.push_back(static_cast<Byte>(removedBoards.size()));
+        v.insert(v.end(), removedBoards.begin(), removedBoards.end());
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte MSG_ID = 56;
+    std::vector<AddressT> addedBoards;
+    std::vector<AddressT> removedBoards;
+};
+
+/**
+ * @brief response to tagged command: [id][requestId lo][requestId hi][response...]
+ */
+class TaggedMessage final : MessageToMaster {
+  public:
+    using RequestIdT = MessageFromMaster::RequestIdT;
+
+    TaggedMessage(RequestIdT request_id, ByteSpan message_bytes) noexcept
+      : requestId{ request_id }
+      , message{ message_bytes }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v(headerSize + message.size());
+        SerializeHeaderTo(v.data(), requestId);
+        std::copy(message.begin(), message.end(), v.begin() + headerSize);
+
+        return v;
+    }
+    static size_t SerializeHeaderTo(Byte *destination, RequestIdT request_id) noexcept
+    {
+        destination[0] = MSG_ID;
+        destination[1] = static_cast<Byte>(request_id & 0xff);
+        destination[2] = static_cast<Byte>(request_id >> 8);
+
+        return headerSize;
+    }
+
+    auto constexpr static headerSize = 3;
+
+  private:
+    constexpr static Byte MSG_ID = 59;
+    RequestIdT            requestId;
+    ByteSpan              message;
+};
+
+/**
+ * @brief one fragment of serialized message which is too large to be passed to socket as a whole:
+ * [id][stream id lo][stream id hi][is last][fragment...]. Other messages may arrive between fragments, master
+ * concatenates fragments with the same stream id in order of arrival until fragment marked as last, the result is the
+ * original message.
+ */
+class MessageChunk final : MessageToMaster {
+  public:
+    using StreamIdT = uint16_t;
+
+    MessageChunk(StreamIdT stream_id, ByteSpan fragment_bytes, bool is_last_fragment) noexcept
+      : streamId{ stream_id }
+      , fragment{ fragment_bytes }
+      , isLast{ is_last_fragment }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v(headerSize + fragment.size());
+        SerializeTo(v.data());
+
+        return v;
+    }
+    /**
+     * @brief serializes into preallocated memory of at least headerSize + fragment size bytes
+     * @return number of bytes written
+     */
+    size_t SerializeTo(Byte *destination) const noexcept
+    {
+        SerializeHeaderTo(destination, streamId, isLast);
+        std::copy(fragment.begin(), fragment.end(), destination + headerSize);
+
+        return headerSize + fragment.size();
+    }
+    static size_t SerializeHeaderTo(Byte *destination, StreamIdT stream_id, bool is_last_fragment) noexcept
+    {
+        destination[0] = MSG_ID;
+        destination[1] = static_cast<Byte>(stream_id);
+        destination[2] = static_cast<Byte>(stream_id >> 8);
+        destination[3] = is_last_fragment ? 1 : 0;
+
+        return headerSize;
+    }
+
+    auto constexpr static headerSize = 4;
+
+  private:
+    constexpr static Byte MSG_ID = 58;
+    StreamIdT             streamId;
+    ByteSpan              fragment;
+    bool                  isLast;
+};
+
+/**
+ * @brief sent only to observers: [id][dropped messages number lo][dropped messages number hi], tells that messages were
+ * dropped right before the next one because observer did not keep up
+ */
+class MessagesDropped final : MessageToMaster {
+  public:
+    explicit MessagesDropped(uint16_t dropped_messages) noexcept
+      : droppedMessages{ dropped_messages }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        return { MSG_ID, static_cast<Byte>(droppedMessages), static_cast<Byte>(droppedMessages >> 8) };
+    }
+
+  private:
+    constexpr static Byte MSG_ID = 62;
+    uint16_t              droppedMessages;
+};
+
+/**
+ * @brief UDP telemetry datagram, all numbers little endian: [id][datagram number, 2][state][scan requestId, 2][board]
+ * [pin][pins done, 2][pins total, 2][pins per second, 2][pin failures, 2][link errors, 2][eta seconds, 2]
+ */
+class ScanTelemetry final : MessageToMaster {
+  public:
+    using RequestIdT = MessageFromMaster::RequestIdT;
+
+    constexpr static uint16_t unknownEta = 0xffff;
+
+    ScanTelemetry(uint16_t            datagram_number,
+                  DeviceStatus::State device_state,
+                  RequestIdT          scan_request_id,
+                  Byte                board_address,
+                  Byte                pin_number,
+                  uint16_t            pins_completed,
+                  uint16_t            pins_total,
+                  uint16_t            pins_per_second,
+                  uint16_t            pin_failures,
+                  uint16_t            link_errors,
+                  uint16_t            eta_seconds) noexcept
+      : datagramNumber{ datagram_number }
+      , state{ device_state }
+      , scanRequestId{ scan_request_id }
+      , boardAddress{ board_address }
+      , pin{ pin_number }
+      , pinsCompleted{ pins_completed }
+      , pinsTotal{ pins_total }
+      , pinsPerSecond{ pins_per_second }
+      , pinFailures{ pin_failures }
+      , linkErrors{ link_errors }
+      , etaSeconds{ eta_seconds }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v{ MSG_ID };
+        v.reserve(datagramSize);
+
+        auto push_u16 = [&v](uint16_t value) {
+            v.push_back(static_cast<Byte>(value & 0xff));
+            v.push_back(static_cast<Byte>(value >> 8));
+        };
+
+        push_u16(datagramNumber);
+        v.push_back(ToUnderlying(state));
+        push_u16(scanRequestId);
+        v.push_back(boardAddress);
+        v.push_back(pin);
+        for (auto const value : { pinsCompleted, pinsTotal, pinsPerSecond, pinFailures, linkErrors, etaSeconds })
+            push_u16(value);
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte   MSG_ID       = 63;
+    constexpr static size_t datagramSize = 20;
+
+    uint16_t            datagramNumber;
+    DeviceStatus::State state;
+    RequestIdT          scanRequestId;
+    Byte                boardAddress;
+    Byte                pin;
+    uint16_t            pinsCompleted;
+    uint16_t            pinsTotal;
+    uint16_t            pinsPerSecond;
+    uint16_t            pinFailures;
+    uint16_t            linkErrors;
+    uint16_t            etaSeconds;
+};
+
+/**
+ * @brief connections of one driven pin which changed since previous sweep of continuous monitoring: [id]
+ * [timestamp ms, 4][sweep number, 4][driven board][driven pin] then [board][pin][1 appeared, 0 disappeared] of every
+ * change, numbers are little endian
+ */
+class ConnectivityChanges final : MessageToMaster {
+  public:
+    using PinAffinityAndId = Board::PinAffinityAndId;
+
+    struct Change {
+        PinAffinityAndId pin;
+        bool             connected;
+    };
+
+    ConnectivityChanges(uint32_t              timestamp_ms,
+                        uint32_t              sweep_number,
+                        PinAffinityAndId      driven_pin,
+                        std::vector<Change> &&new_changes) noexcept
+      : timestampMs{ timestamp_ms }
+      , sweepNumber{ sweep_number }
+      , drivenPin{ driven_pin }
+      , changes{ std::move(new_changes) }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(sizeof(MSG_ID) + 2 * sizeof(uint32_t) + sizeof(drivenPin) + changes.size() * 3);
+
+        v.push_back(MSG_ID);
+        for (auto const value : { timestampMs, sweepNumber }) {
+            for (size_t byte_idx = 0; byte_idx < sizeof(value); byte_idx++)
+                v.push_back(static_cast<Byte>(value >> (8 * byte_idx)));
+        }
+        v.push_back(drivenPin.boardAddress);
+        v.push_back(drivenPin.pinId);
+
+        for (auto const &change : changes) {
+            v.push_back(change.pin.boardAddress);
+            v.push_back(change.pin.pinId);
+            v.push_back(change.connected ? 1 : 0);
+        }
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte MSG_ID = 64;
+    uint32_t              timestampMs;
+    uint32_t              sweepNumber;
+    PinAffinityAndId      drivenPin;
+    std::vector<Change>   changes;
+};
+
+/**
+ * @brief periodic summary of wiggle test: [id][summary number, 2][samples, 4][untracked glitches, 2][pairs number]
+ * then for every pair of driven pin and pin connected to it [driven board][driven pin][board][pin]
+ * [connected at baseline][min voltage][max voltage][glitches, 2][first glitch ms, 4][last glitch ms, 4]. Glitch is a
+ * sample in which pair's connection differs from baseline. Untracked glitches are transitions between connected and
+ * open of pins which did not fit into pairs table, numbers are little endian.
+ */
+class WiggleSummary final : MessageToMaster {
+  public:
+    using PinAffinityAndId = Board::PinAffinityAndId;
+
+    struct PairStatistics {
+        PinAffinityAndId drivenPin;
+        PinAffinityAndId readPin;
+        bool             connectedAtBaseline;
+        Byte             minVoltage;
+        Byte             maxVoltage;
+        uint16_t         glitches;
+        uint32_t         firstGlitchMs;
+        uint32_t         lastGlitchMs;
+    };
+
+    WiggleSummary(uint16_t                      summary_number,
+                  uint32_t                      samples_number,
+                  uint16_t                      untracked_glitches,
+                  std::vector<PairStatistics> &&pairs_statistics) noexcept
+      : summaryNumber{ summary_number }
+      , samples{ samples_number }
+      , untrackedGlitches{ untracked_glitches }
+      , pairs{ std::move(pairs_statistics) }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(headerSize + pairs.size() * pairSize);
+
+        auto push_value = [&v](auto value) {
+            for (size_t byte_idx = 0; byte_idx < sizeof(value); byte_idx++)
+                v.push_back(static_cast<Byte>(value >> (8 * byte_idx)));
+        };
+
+        v.push_back(MSG_ID);
+        push_value(summaryNumber);
+        push_value(samples);
+        push_value(untrackedGlitches);
+        v.push_back(static_cast<Byte>(pairs.size()));
+
+        for (auto const &pair : pairs) {
+            v.insert(v.end(),
+                     { pair.drivenPin.boardAddress,
+                       pair.drivenPin.pinId,
+                       pair.readPin.boardAddress,
+                       pair.readPin.pinId,
+                       static_cast<Byte>(pair.connectedAtBaseline ? 1 : 0),
+                       pair.minVoltage,
+                       pair.maxVoltage });
+            push_value(pair.glitches);
+            push_value(pair.firstGlitchMs);
+            push_value(pair.lastGlitchMs);
+        }
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte   MSG_ID     = 65;
+    constexpr static size_t headerSize = 10;
+    constexpr static size_t pairSize   = 17;
+
+    uint16_t                    summaryNumber;
+    uint32_t                    samples;
+    uint16_t                    untrackedGlitches;
+    std::vector<PairStatistics> pairs;
+};
+
+/**
+ * @brief MeasureAll result encoded against frame master already has: [id][frame, 2][reference frame, 2][changes, 2]
+ * then [board][pin on board][voltage] for every pin which changed. Keyframe has reference frame keyframeReference and
+ * lists every pin of every board, it replaces master's snapshot completely, numbers are little endian.
+ */
+class AllBoardsVoltagesDelta final : MessageToMaster {
+  public:
+    using FrameNumT = uint16_t;
+
+    struct Change {
+        Board::AddressT boardAddress;
+        Byte            pinOnBoard;
+        Byte            voltage;
+    };
+
+    constexpr static FrameNumT keyframeReference = 0xffff;
+
+    AllBoardsVoltagesDelta(FrameNumT frame_number, FrameNumT reference_frame, std::vector<Change> &&changes) noexcept
+      : frameNumber{ frame_number }
+      , referenceFrame{ reference_frame }
+      , pinsChanges{ std::move(changes) }
+    { }
+
+    [[nodiscard]] bool IsKeyframe() const noexcept { return referenceFrame == keyframeReference; }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(headerSize + pinsChanges.size() * changeSize);
+
+        auto push_value = [&v](auto value) {
+            for (size_t byte_idx = 0; byte_idx < sizeof(value); byte_idx++)
+                v.push_back(static_cast<Byte>(value >> (8 * byte_idx)));
+        };
+
+        v.push_back(MSG_ID);
+        push_value(frameNumber);
+        push_value(referenceFrame);
+        push_value(static_cast<uint16_t>(pinsChanges.size()));
+
+        for (auto const &change : pinsChanges)
+            v.insert(v.end(), { change.boardAddress, change.pinOnBoard, change.voltage });
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte   MSG_ID     = 66;
+    constexpr static size_t headerSize = 7;
+    constexpr static size_t changeSize = 3;
+
+    FrameNumT           frameNumber;
+    FrameNumT           referenceFrame;
+    std::vector<Change> pinsChanges;
+};
+
+/**
+ * @brief result of whole connections scan as sparse upper triangular adjacency in compressed sparse row form. Pin is
+ * identified by node index board address * pin count + harness pin, every connection is listed once in row of its
+ * lower pin. Layout: [id][flags][connections][rows] then for every row with connections [row index delta][columns]
+ * followed by [column delta] of every column, with [voltage] after each column if flags have withVoltagesFlag. Row
+ * delta is counted from previous row, first column delta from row index and next ones from previous column, all
+ * counts and deltas are unsigned LEB128 varints.
+ */
+class Netlist final : MessageToMaster {
+  public:
+    using NodeIndexT       = uint16_t;
+    using PinAffinityAndId = Board::PinAffinityAndId;
+
+    struct Connection {
+        NodeIndexT lowerPin;
+        NodeIndexT higherPin;
+        Byte       voltage;
+    };
+
+    constexpr static Byte withVoltagesFlag = 0x01;
+
+    [[nodiscard]] static NodeIndexT NodeIndex(PinAffinityAndId pin) noexcept
+    {
+        return static_cast<NodeIndexT>(pin.boardAddress * Board::pinCount + pin.pinId);
+    }
+
+    /**
+     * @param connections must be sorted by lower pin then by higher pin, without duplicates
+     */
+    Netlist(std::vector<Connection> &&connections, bool with_voltages) noexcept
+      : netConnections{ std::move(connections) }
+      , withVoltages{ with_voltages }
+    { }
+
+    std::vector<Byte> Serialize() noexcept final
+    {
+        std::vector<Byte> v;
+        v.reserve(headerSize + netConnections.size() * (withVoltages ? 3 : 2));
+
+        auto push_varint = [&v](uint32_t value) {
+            while (value >= 0x80) {
+                v.push_back(static_cast<Byte>(value | 0x80));
+                value >>= 7;
+            }
+            v.push_back(static_cast<Byte>(value));
+        };
+
+        size_t rows_number = 0;
+        for (size_t idx = 0; idx < netConnections.size(); idx++) {
+            if (idx == 0 or netConnections[idx].lowerPin != netConnections[idx - 1].lowerPin)
+                rows_number++;
+        }
+
+        v.push_back(MSG_ID);
+        v.push_back(withVoltages ? withVoltagesFlag : 0);
+        push_varint(netConnections.size());
+        push_varint(rows_number);
+
+        NodeIndexT previous_row = 0;
+        for (auto row_begin = netConnections.begin(); row_begin != netConnections.end();) {
+            auto const row     = row_begin->lowerPin;
+            auto const row_end = std::find_if(row_begin, netConnections.end(), [row](Connection const &connection) {
+                return connection.lowerPin != row;
+            });
+
+            push_varint(row - previous_row);
+            push_varint(std::distance(row_begin, row_end));
+
+            auto previous_column = row;
+            for (auto connection = row_begin; connection != row_end; ++connection) {
+                push_varint(connection->higherPin - previous_column);
+                if (withVoltages)
+                    v.push_back(connection->voltage);
+
+                previous_column = connection->higherPin;
+            }
+
+            previous_row = row;
+            row_begin    = row_end;
+        }
+
+        return v;
+    }
+
+  private:
+    constexpr static Byte   MSG_ID     = 67;
+    constexpr static size_t headerSize = 8;
+
+    std::vector<Connection> netConnections;
+    bool                    withVoltages;
 };
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include "asio.hpp"
+#include "../../proj_cfg/project_configs.hpp"
+#include "esp_logger.hpp"
+#include "byte_span.hpp"
+#include "message.hpp"
+
+/**
+ * @brief read only connection which receives copy of messages sent to master, except master only ones such as
+ * AllBoardsVoltagesDelta which is not a keyframe. Every observer has its own bounded queue, messages which do not fit
+ * are dropped and observer is told how many were dropped, so slow observer never delays master's session or producers
+ * of messages.
+ */
+template<size_t QueueLength, size_t SlotCapacity>
+class ObserverSession {
+  public:
+    using Byte = uint8_t;
+
+    explicit ObserverSession(asio::io_context &io_context) noexcept
+      : socket{ io_context }
+    { }
+    ObserverSession(ObserverSession const &)            = delete;
+    ObserverSession &operator=(ObserverSession const &) = delete;
+
+    /**
+     * @brief session may take new connection only when previous one is closed and its operations are finished
+     */
+    [[nodiscard]] bool IsFree() const noexcept { return not isOpen and not writeInProgress and not readInProgress; }
+
+    void Attach(asio::ip::tcp::socket &&new_socket) noexcept
+    {
+        socket     = std::move(new_socket);
+        isOpen     = true;
+        head       = 0;
+        queuedNum  = 0;
+        droppedNum = 0;
+
+        auto err_code = asio::error_code();
+        socket.set_option(asio::ip::tcp::no_delay(true), err_code);
+
+        StartDiscardingInput();
+    }
+    void Offer(ByteSpan message) noexcept
+    {
+        if (not isOpen)
+            return;
+
+        if (droppedNum != 0 and FreeSlots() >= 2) {
+            auto notice = MessagesDropped(droppedNum).Serialize();
+            Enqueue(ByteSpan{ notice.data(), notice.size() });
+            droppedNum = 0;
+        }
+
+        // message must not overtake notice about dropped ones
+        if (droppedNum != 0 or FreeSlots() == 0 or message.size() > SlotCapacity) {
+            droppedNum++;
+            return;
+        }
+
+        Enqueue(message);
+        StartWrite();
+    }
+
+  private:
+    struct Slot {
+        size_t                         size;
+        std::array<Byte, SlotCapacity> bytes;
+    };
+    static_assert(offsetof(Slot, bytes) == sizeof(size_t), "length prefix must be contiguous with message bytes");
+
+    [[nodiscard]] size_t FreeSlots() const noexcept { return QueueLength - queuedNum; }
+    Slot                &SlotAt(size_t position) noexcept { return slots[(head + position) % QueueLength]; }
+
+    void Enqueue(ByteSpan message) noexcept
+    {
+        auto &slot = SlotAt(queuedNum);
+        std::copy(message.begin(), message.end(), slot.bytes.begin());
+        slot.size = message.size();
+        queuedNum++;
+    }
+    void StartWrite() noexcept
+    {
+        if (writeInProgress or not isOpen or queuedNum == 0)
+            return;
+
+        auto batch_size = size_t{ 0 };
+
+        writeBuffers = {};
+        inFlightNum  = 0;
+        while (inFlightNum < queuedNum and batch_size < ProjCfg::Socket::WriteCoalescingBudgetBytes) {
+            auto &slot                = SlotAt(inFlightNum);
+            writeBuffers[inFlightNum] = asio::buffer(&slot.size, sizeof(size_t) + slot.size);
+            batch_size += sizeof(size_t) + slot.size;
+            inFlightNum++;
+        }
+
+        writeInProgress = true;
+        asio::async_write(socket, writeBuffers, [this](asio::error_code const &err_code, size_t) {
+            writeInProgress = false;
+
+            if (err_code) {
+                Close("write failed: " + err_code.message());
+                return;
+            }
+
+            head = (head + inFlightNum) % QueueLength;
+            queuedNum -= inFlightNum;
+            StartWrite();
+        });
+    }
+    /**
+     * @brief observers are read only, input is read only to notice disconnection
+     */
+    void StartDiscardingInput() noexcept
+    {
+        readInProgress = true;
+        socket.async_read_some(asio::buffer(discardBuffer), [this](asio::error_code const &err_code, size_t) {
+            readInProgress = false;
+
+            if (err_code) {
+                Close("connection closed: " + err_code.message());
+                return;
+            }
+
+            if (isOpen)
+                StartDiscardingInput();
+        });
+    }
+    void Close(std::string &&reason) noexcept
+    {
+        if (not isOpen)
+            return;
+
+        console.Log("Observer disconnected, " + reason);
+
+        isOpen        = false;
+        auto err_code = asio::error_code();
+        socket.shutdown(asio::socket_base::shutdown_type::shutdown_both, err_code);
+        socket.close(err_code);
+    }
+
+    Logger console{ "observer", ProjCfg::EnableLogForComponent::Socket };
+
+    asio::ip::tcp::socket                         socket;
+    std::array<Slot, QueueLength>                 slots{};
+    std::array<asio::const_buffer, QueueLength>   writeBuffers{};
+    std::array<Byte, 16>                          discardBuffer{};
+    size_t                                        head{ 0 };
+    size_t                                        queuedNum{ 0 };
+    size_t                                        inFlightNum{ 0 };
+    uint16_t                                      droppedNum{ 0 };
+    bool                                          isOpen{ false };
+    bool                                          writeInProgress{ false };
+    bool                                          readInProgress{ false };
+};
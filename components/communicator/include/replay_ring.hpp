@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_span.hpp"
+
+/**
+ * @brief messages to master numbered in order of sending and kept until master acknowledges their reception, so they
+ * can be sent again after reconnection. Messages which were not sent yet are never dropped, when space is needed the
+ * oldest sent but not acknowledged message is dropped.
+ */
+template<size_t SlotsNumber, size_t SlotCapacity>
+class ReplayRing {
+  public:
+    using Byte = uint8_t;
+    using SeqT = uint32_t;
+
+    /**
+     * @brief message length precedes message bytes in memory, so slot goes to socket as one buffer
+     */
+    struct Slot {
+        size_t                         size;
+        std::array<Byte, SlotCapacity> bytes;
+    };
+    static_assert(offsetof(Slot, bytes) == sizeof(size_t), "length prefix must be contiguous with message bytes");
+
+    auto constexpr static capacity = SlotCapacity;
+
+    [[nodiscard]] bool CanStore() const noexcept { return nextSeq - firstSeq < SlotsNumber or firstSeq < sendSeq; }
+    /**
+     * @return false if message is too large or ring is full of messages which were not sent yet
+     */
+    bool Store(ByteSpan message) noexcept
+    {
+        if (message.size() > SlotCapacity or not CanStore())
+            return false;
+
+        if (nextSeq - firstSeq == SlotsNumber)
+            firstSeq++;
+
+        auto &slot = At(nextSeq);
+        std::copy(message.begin(), message.end(), slot.bytes.begin());
+        slot.size = message.size();
+        nextSeq++;
+
+        return true;
+    }
+
+    [[nodiscard]] Slot &At(SeqT seq) noexcept { return slots[seq % SlotsNumber]; }
+    [[nodiscard]] bool  HasUnsent() const noexcept { return sendSeq != nextSeq; }
+    [[nodiscard]] SeqT  SendPosition() const noexcept { return sendSeq; }
+    [[nodiscard]] SeqT  EndPosition() const noexcept { return nextSeq; }
+    [[nodiscard]] SeqT  OldestPosition() const noexcept { return firstSeq; }
+
+    void MarkSent(SeqT sent_up_to) noexcept { sendSeq = sent_up_to; }
+    /**
+     * @param received_num number of messages received by master since session start
+     */
+    void Acknowledge(SeqT received_num) noexcept { firstSeq = std::max(firstSeq, std::min(received_num, sendSeq)); }
+    /**
+     * @brief continues sending from the first message master did not receive, or from the oldest stored one if it was
+     * already dropped
+     */
+    void Rewind(SeqT received_num) noexcept
+    {
+        Acknowledge(received_num);
+        sendSeq = firstSeq;
+    }
+
+  private:
+    std::array<Slot, SlotsNumber> slots{};
+    SeqT                          firstSeq{ 0 };
+    SeqT                          sendSeq{ 0 };
+    SeqT                          nextSeq{ 0 };
+};
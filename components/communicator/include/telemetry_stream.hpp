@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "asio.hpp"
+#include "../../proj_cfg/project_configs.hpp"
+#include "esp_logger.hpp"
+#include "my_mutex.hpp"
+#include "message.hpp"
+
+/**
+ * @brief position of running scan, published by scanning task after every pin
+ */
+struct ScanProgress {
+    using Byte       = uint8_t;
+    using RequestIdT = MessageFromMaster::RequestIdT;
+
+    DeviceStatus::State state{ DeviceStatus::State::Idle };
+    RequestIdT          requestId{ MessageFromMaster::untaggedRequestId };
+    Byte                board{ 0 };
+    Byte                pin{ 0 };
+    uint16_t            pinsCompleted{ 0 };
+    uint16_t            pinsTotal{ 0 };
+    uint16_t            pinFailures{ 0 };
+};
+
+/**
+ * @brief fire-and-forget UDP datagrams with scan progress sent to subscriber's port at subscribed interval. Only the
+ * latest progress is kept, datagram is skipped while previous one is still being sent, so telemetry never queues up
+ * and never competes with results on TCP stream. Runs on socket io task.
+ */
+class TelemetryStream {
+  public:
+    using PortNumT = unsigned short;
+    using Clock    = std::chrono::steady_clock;
+
+    explicit TelemetryStream(asio::io_context &io_context) noexcept
+      : udpSocket{ io_context }
+      , timer{ io_context }
+    { }
+
+    /**
+     * @brief may be called from any task
+     */
+    void Publish(ScanProgress const &progress) noexcept
+    {
+        std::lock_guard<Mutex> lock{ progressMutex };
+        latestProgress = progress;
+    }
+    void CountLinkError() noexcept { linkErrors++; }
+    /**
+     * @param subscriber address of peer which sent subscription, it is not necessarily the gateway
+     * @param port subscriber's UDP port, 0 stops the stream
+     * @param interval_ms interval between datagrams, limited from below by TelemetryMinIntervalMs
+     */
+    void Subscribe(asio::ip::address const &subscriber, PortNumT port, uint16_t interval_ms) noexcept
+    {
+        timer.cancel();
+
+        if (port == 0) {
+            console.Log("Telemetry stream stopped");
+            isSubscribed = false;
+            return;
+        }
+
+        auto const new_destination = asio::ip::udp::endpoint(subscriber, port);
+
+        if (udpSocket.is_open() and destination.protocol() != new_destination.protocol()) {
+            auto err_code = asio::error_code();
+            udpSocket.close(err_code);
+        }
+
+        if (not udpSocket.is_open()) {
+            auto err_code = asio::error_code();
+            udpSocket.open(new_destination.protocol(), err_code);
+
+            if (err_code) {
+                console.LogError("Telemetry socket open failed! Err: " + err_code.message());
+                return;
+            }
+        }
+
+        destination  = new_destination;
+        intervalMs   = std::max<int>(interval_ms, ProjCfg::Socket::TelemetryMinIntervalMs);
+        isSubscribed = true;
+        lastSample   = Clock::now();
+
+        console.Log("Telemetry stream to " + subscriber.to_string() + ":" + std::to_string(port) + " every " +
+                    std::to_string(intervalMs) + "ms");
+        ScheduleNextDatagram();
+    }
+
+  private:
+    void ScheduleNextDatagram() noexcept
+    {
+        timer.expires_after(std::chrono::milliseconds(intervalMs));
+        timer.async_wait([this](asio::error_code const &err_code) {
+            if (err_code or not isSubscribed)
+                return;
+
+            SendDatagram();
+            ScheduleNextDatagram();
+        });
+    }
+    void SendDatagram() noexcept
+    {
+        auto progress = ScanProgress{};
+        {
+            std::lock_guard<Mutex> lock{ progressMutex };
+            progress = latestProgress;
+        }
+
+        auto const now        = Clock::now();
+        auto const elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSample).count();
+
+        // counter restarts with every new scan
+        auto const pins_done_since_last = (progress.pinsCompleted >= lastPinsCompleted)
+                                            ? progress.pinsCompleted - lastPinsCompleted
+                                            : progress.pinsCompleted;
+        auto const pins_per_second =
+          (elapsed_ms > 0) ? static_cast<uint16_t>(pins_done_since_last * 1000 / elapsed_ms) : uint16_t{ 0 };
+        auto const pins_left   = std::max(progress.pinsTotal, progress.pinsCompleted) - progress.pinsCompleted;
+        auto const eta_seconds = (pins_per_second != 0) ? static_cast<uint16_t>(pins_left / pins_per_second)
+                                                        : ScanTelemetry::unknownEta;
+
+        lastSample        = now;
+        lastPinsCompleted = progress.pinsCompleted;
+
+        if (sendInProgress)
+            return;
+
+        datagram = ScanTelemetry(datagramsSent++,
+                                 progress.state,
+                                 progress.requestId,
+                                 progress.board,
+                                 progress.pin,
+                                 progress.pinsCompleted,
+                                 progress.pinsTotal,
+                                 pins_per_second,
+                                 progress.pinFailures,
+                                 linkErrors,
+                                 eta_seconds)
+                     .Serialize();
+
+        sendInProgress = true;
+        udpSocket.async_send_to(asio::buffer(datagram), destination, [this](asio::error_code const &err_code, size_t) {
+            sendInProgress = false;
+
+            if (err_code)
+                console.LogError("Telemetry datagram not sent! Err: " + err_code.message());
+        });
+    }
+
+    Logger console{ "telemetry", ProjCfg::EnableLogForComponent::Socket };
+
+    asio::ip::udp::socket   udpSocket;
+    asio::ip::udp::endpoint destination;
+    asio::steady_timer      timer;
+
+    Mutex        progressMutex;
+    ScanProgress latestProgress;
+
+    std::vector<uint8_t> datagram;
+    Clock::time_point    lastSample;
+    int                  intervalMs{ ProjCfg::Socket::TelemetryMinIntervalMs };
+    uint16_t             lastPinsCompleted{ 0 };
+    uint16_t             datagramsSent{ 0 };
+    uint16_t             linkErrors{ 0 };
+    bool                 isSubscribed{ false };
+    bool                 sendInProgress{ false };
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+#include "../../proj_cfg/project_configs.hpp"
+#include "board.hpp"
+#include "message.hpp"
+
+/**
+ * @brief encodes MeasureAll results as changes against frame acknowledged by master. Recently sent frames are kept
+ * as master sees them after applying them, so acknowledgement may lag behind sending. Keyframe is sent when
+ * acknowledged frame is unknown, when set of boards changed and every DeltaKeyframeInterval frames.
+ * History follows master's acknowledgements only, observers may drop frames and have no way to acknowledge, so they
+ * receive keyframes only and deltas are sent to master alone.
+ */
+class VoltagesDeltaEncoder {
+  public:
+    using Byte             = uint8_t;
+    using FrameNumT        = AllBoardsVoltagesDelta::FrameNumT;
+    using Change           = AllBoardsVoltagesDelta::Change;
+    using OneBoardVoltages = Board::OneBoardVoltages;
+
+    /**
+     * @param deadband pin is reported only if its voltage differs from acknowledged frame by more than deadband
+     */
+    AllBoardsVoltagesDelta Encode(std::vector<OneBoardVoltages> const &boards_voltages,
+                                  FrameNumT                            acknowledged_frame,
+                                  Byte                                 deadband) noexcept
+    {
+        auto const frame_number = nextFrameNumber;
+        nextFrameNumber++;
+        if (nextFrameNumber == AllBoardsVoltagesDelta::keyframeReference)
+            nextFrameNumber = 0;
+
+        auto const *reference   = FindFrame(acknowledged_frame);
+        auto const  is_keyframe = reference == nullptr or
+                                 framesSinceKeyframe + 1 >= ProjCfg::Socket::DeltaKeyframeInterval or
+                                 not HaveSameBoards(reference->boardsVoltages, boards_voltages);
+
+        std::vector<Change> changes;
+        auto                master_view = boards_voltages;
+
+        for (size_t board_idx = 0; board_idx < boards_voltages.size(); board_idx++) {
+            auto const &measured = boards_voltages[board_idx];
+
+            for (size_t pin = 0; pin < Board::pinCount; pin++) {
+                auto const voltage = measured.pinsVoltages[pin];
+
+                if (not is_keyframe) {
+                    auto const acknowledged_voltage = reference->boardsVoltages[board_idx].pinsVoltages[pin];
+
+                    if (std::abs(voltage - acknowledged_voltage) <= deadband) {
+                        master_view[board_idx].pinsVoltages[pin] = acknowledged_voltage;
+                        continue;
+                    }
+                }
+
+                changes.push_back(Change{ measured.boardAddress,
+                                          static_cast<Byte>(Board::logicPinToPinOnBoardMapping.at(pin)),
+                                          voltage });
+            }
+        }
+
+        framesSinceKeyframe = is_keyframe ? 0 : framesSinceKeyframe + 1;
+
+        auto &slot          = sentFrames[nextSlot];
+        slot.isValid        = true;
+        slot.frameNumber    = frame_number;
+        slot.boardsVoltages = std::move(master_view);
+        nextSlot            = (nextSlot + 1) % sentFrames.size();
+
+        return AllBoardsVoltagesDelta{ frame_number,
+                                       is_keyframe ? AllBoardsVoltagesDelta::keyframeReference : acknowledged_frame,
+                                       std::move(changes) };
+    }
+
+  private:
+    struct SentFrame {
+        bool                          isValid     = false;
+        FrameNumT                     frameNumber = 0;
+        std::vector<OneBoardVoltages> boardsVoltages;
+    };
+
+    [[nodiscard]] SentFrame const *FindFrame(FrameNumT frame_number) const noexcept
+    {
+        if (frame_number == AllBoardsVoltagesDelta::keyframeReference)
+            return nullptr;
+
+        for (auto const &frame : sentFrames) {
+            if (frame.isValid and frame.frameNumber == frame_number)
+                return &frame;
+        }
+
+        return nullptr;
+    }
+    [[nodiscard]] static bool HaveSameBoards(std::vector<OneBoardVoltages> const &lhs,
+                                             std::vector<OneBoardVoltages> const &rhs) noexcept
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t board_idx = 0; board_idx < lhs.size(); board_idx++) {
+            if (lhs[board_idx].boardAddress != rhs[board_idx].boardAddress)
+                return false;
+        }
+
+        return true;
+    }
+
+    std::array<SentFrame, ProjCfg::Socket::DeltaHistoryFrames> sentFrames{};
+    size_t                                                     nextSlot            = 0;
+    FrameNumT                                                  nextFrameNumber     = 0;
+    int                                                        framesSinceKeyframe = 0;
+};
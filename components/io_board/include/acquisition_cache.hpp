@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "board.hpp"
+
+/**
+ * @brief last voltage tables of all boards together with the time and the output drive state of the bus under which
+ * they were taken. Tables are answered only within freshness window and only while drive state is exactly the same.
+ * Drive state does not show that outputs were changed and restored meanwhile, so owner must Invalidate cache on every
+ * output change and on every change of set of boards.
+ */
+class AcquisitionCache {
+  public:
+    using Byte             = uint8_t;
+    using AddressT         = Board::AddressT;
+    using PinNumT          = Board::PinNumT;
+    using OneBoardVoltages = Board::OneBoardVoltages;
+
+    struct BoardDrive {
+        bool operator==(BoardDrive const &rhs) const noexcept
+        {
+            return address == rhs.address and outputIsEnabled == rhs.outputIsEnabled and
+                   enabledPin == rhs.enabledPin and outputLevel == rhs.outputLevel;
+        }
+
+        AddressT             address;
+        bool                 outputIsEnabled;
+        PinNumT              enabledPin;
+        Board::OutputVoltage outputLevel;
+    };
+    /**
+     * @brief outputs of all boards, and pin driven for measurement if there is one
+     */
+    struct DriveState {
+        bool operator==(DriveState const &rhs) const noexcept
+        {
+            return boards == rhs.boards and hasDrivenPin == rhs.hasDrivenPin and drivenBoard == rhs.drivenBoard and
+                   drivenPin == rhs.drivenPin;
+        }
+
+        std::vector<BoardDrive> boards;
+        bool                    hasDrivenPin = false;
+        AddressT                drivenBoard  = 0;
+        PinNumT                 drivenPin    = 0;
+    };
+
+    /**
+     * @param window_ms 0 disables cache
+     */
+    void SetFreshnessWindow(uint32_t window_ms) noexcept
+    {
+        freshnessWindowMs = window_ms;
+        Invalidate();
+    }
+    [[nodiscard]] bool IsEnabled() const noexcept { return freshnessWindowMs != 0; }
+
+    [[nodiscard]] std::optional<std::vector<OneBoardVoltages>> Find(DriveState const &state,
+                                                                    uint32_t          now_ms) const noexcept
+    {
+        auto entry = std::find_if(entries.begin(), entries.end(), [&](Entry const &candidate) {
+            return IsFresh(candidate, now_ms) and candidate.state == state;
+        });
+
+        if (entry == entries.end())
+            return std::nullopt;
+
+        return entry->tables;
+    }
+    void Store(DriveState &&state, std::vector<OneBoardVoltages> const &tables, uint32_t now_ms) noexcept
+    {
+        if (not IsEnabled())
+            return;
+
+        entries.erase(std::remove_if(entries.begin(),
+                                     entries.end(),
+                                     [&](Entry const &entry) {
+                                         return not IsFresh(entry, now_ms) or entry.state == state;
+                                     }),
+                      entries.end());
+
+        if (entries.size() == ProjCfg::BoardsConfigs::AcquisitionCacheEntries)
+            entries.erase(entries.begin());
+
+        entries.push_back(Entry{ std::move(state), tables, now_ms });
+    }
+    void Invalidate() noexcept { entries.clear(); }
+
+  private:
+    struct Entry {
+        DriveState                    state;
+        std::vector<OneBoardVoltages> tables;
+        uint32_t                      timestampMs;
+    };
+
+    [[nodiscard]] bool IsFresh(Entry const &entry, uint32_t now_ms) const noexcept
+    {
+        return now_ms - entry.timestampMs < freshnessWindowMs;
+    }
+
+    std::vector<Entry> entries;
+    uint32_t           freshnessWindowMs{ ProjCfg::BoardsConfigs::AcquisitionCacheWindowMs };
+};
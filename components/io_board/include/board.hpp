@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstdlib>
 #include <optional>
 #include <mutex>
@@ -24,6 +25,7 @@ class Board {
     using CommandArgT              = Byte;
     using AllPinsVoltages          = std::array<ADCValueT, pinCount>;
     using AllPinsVoltages8B        = std::array<AdcValueLoRes, pinCount>;
+    using AllPinsVoltagesPacked    = std::array<Byte, pinCount * 10 / 8>;
     using OutputVoltageRealT       = float;
     using CircuitParamT            = float;
     using VoltageT                 = CircuitParamT;
@@ -81,11 +83,15 @@ class Board {
         enum SpecialMeasurements : Byte {
             MeasureAll = 33,
             MeasureVCC,
-            MeasureGND
+            MeasureGND,
+            MeasureAllHiRes,
+            MeasureAllBitmap
         };
 
         TickType_t static constexpr timeToWaitForResponseAllPinsMs =
           ProjCfg::BoardsConfigs::DelayBeforeReadAllPinsVoltagesResult;
+        TickType_t static constexpr timeToWaitForResponseAllPinsHiResMs =
+          ProjCfg::BoardsConfigs::DelayBeforeReadAllPinsVoltagesResult;
         TickType_t static constexpr timeToWaitForResponseOnePinMs = 15;
         int static constexpr delayForSequentialRun                = timeToWaitForResponseAllPinsMs + 3;
         PinNum pin;
@@ -132,6 +138,25 @@ class Board {
         Byte static constexpr targetVersion      = 19;
         auto static constexpr delayForResponseMs = 2;
     };
+    /**
+     * @brief first firmware versions of board implementing optional features
+     */
+    struct FirmwareFeatures {
+        Byte static constexpr hiResReadoutSinceVersion  = 20;
+        Byte static constexpr bitmapReadoutSinceVersion = 21;
+    };
+    /**
+     * @brief in bitmap readout board answers with 4 bytes bitmap of pins which voltage is at or above threshold,
+     * followed by voltages of those pins only, in ascending pin order
+     */
+    struct BitmapReadoutCmd {
+        Byte static constexpr setThresholdCmd = 0xca;
+        using BitmapT                         = uint32_t;
+    };
+    enum class ReadoutMode {
+        FullTable,
+        Bitmap
+    };
     struct SetInternalParametersCmd {
         Byte static constexpr cmd                = 0xC8;
         auto static constexpr numberOfParams     = 7;
@@ -199,6 +224,42 @@ class Board {
 
         return harnessToLogicPinNumMapping.at(harness_pin_num);
     }
+    /**
+     * @brief 10 bit values are packed in groups of four pins into five bytes: first four bytes are lower 8 bits of
+     * each pin, the fifth byte holds two upper bits of each pin, first pin of group in least significant bits
+     */
+    static AllPinsVoltages UnpackHiResVoltages(AllPinsVoltagesPacked const &packed) noexcept
+    {
+        auto constexpr pins_in_group = 4;
+        auto constexpr group_size    = pins_in_group + 1;
+
+        AllPinsVoltages voltages{};
+        for (auto pin = 0; pin < pinCount; pin++) {
+            auto group_start  = (pin / pins_in_group) * group_size;
+            auto pin_in_group = pin % pins_in_group;
+            auto upper_bits   = (packed[group_start + pins_in_group] >> (pin_in_group * 2)) & 0b11;
+
+            voltages[pin] = static_cast<ADCValueT>((upper_bits << 8) | packed[group_start + pin_in_group]);
+        }
+
+        return voltages;
+    }
+    static AllPinsVoltagesPacked PackHiResVoltages(AllPinsVoltages const &voltages) noexcept
+    {
+        auto constexpr pins_in_group = 4;
+        auto constexpr group_size    = pins_in_group + 1;
+
+        AllPinsVoltagesPacked packed{};
+        for (auto pin = 0; pin < pinCount; pin++) {
+            auto group_start  = (pin / pins_in_group) * group_size;
+            auto pin_in_group = pin % pins_in_group;
+
+            packed[group_start + pin_in_group] = static_cast<Byte>(voltages[pin] & 0xff);
+            packed[group_start + pins_in_group] |= static_cast<Byte>(((voltages[pin] >> 8) & 0b11) << (pin_in_group * 2));
+        }
+
+        return packed;
+    }
     static VoltageT CalculateVoltageFromAdcValue(Board::ADCValueT adc_value) noexcept
     {
         VoltageT constexpr reference = 1.1;
@@ -228,6 +289,10 @@ class Board {
         if (result != Result::Good) {
             console.LogError("Voltage setting on pin " + std::to_string(pin) + " unsuccessful");
         }
+        else {
+            outputIsEnabled = pin != ToUnderlying(VoltageSetCmd::Special::DisableAll);
+            enabledOutputPin = pin;
+        }
 
         return result;
     }
@@ -256,6 +321,21 @@ class Board {
           static_cast<std::underlying_type_t<VoltageSetCmd::Special>>(VoltageSetCmd::Special::DisableAll),
           retry_times);
     }
+    Result SetBitmapThreshold(AdcValueLoRes threshold, int retry_times = 0) noexcept
+    {
+        auto result = SendCmd(BitmapReadoutCmd::setThresholdCmd, CommandArgT{ threshold }, retry_times);
+
+        if (result != Result::Good)
+            console.LogError("Bitmap threshold setting unsuccessful");
+        else
+            bitmapThreshold = threshold;
+
+        return result;
+    }
+    /**
+     * @brief selects how voltages are read by measurement task, bitmap readout is used only if firmware supports it
+     */
+    void SetReadoutMode(ReadoutMode mode) noexcept { readoutMode = mode; }
     Result SetInternalParameters(SetInternalParametersCmd::InternalParamsT params, int retry_times = 0) noexcept
     {
         auto buffer = reinterpret_cast<std::array<Byte, sizeof(params)> *>(&params);
@@ -414,6 +494,36 @@ class Board {
 
         return { comm_result, response };
     }
+    /**
+     * @brief first half of GetBoardCounterValue, allows to issue the command to many boards and wait for their
+     * responses only once (see ReadBoardCounterValue)
+     */
+    Result RequestBoardCounterValue(int retry_times = 0) noexcept
+    {
+        auto result = SendCmd(GetInternalCounter::command, retry_times);
+
+        if (result != Result::Good)
+            console.LogError("Get counter value request not succeeded");
+
+        return result;
+    }
+    [[nodiscard]] std::pair<Result, std::optional<InternalCounterT>> ReadBoardCounterValue(int retry_times = 0) noexcept
+    {
+        auto [comm_result, response] = ReadResponse<InternalCounterT>(retry_times);
+
+        if (comm_result != Result::Good) {
+            console.LogError("Get counter value response not obtained");
+            return { comm_result, std::nullopt };
+        }
+
+        if (*response == UINT32_MAX or *response == 0) {
+            console.LogError("Board did not answer properly for GetInternalCounter command, result is:" +
+                             std::to_string(*response));
+            return { Result::UnhealthyAnswerValue, std::nullopt };
+        }
+
+        return { comm_result, response };
+    }
     [[nodiscard]] std::pair<Result, std::optional<ADCValueT>> GetPinVoltage(Byte pin, int retry_times = 0) noexcept
     {
         auto [comm_result, response] = SendCmdAndReadResponse<ADCValueT>(static_cast<Byte>(Command::GetPinVoltage),
@@ -442,13 +552,106 @@ class Board {
 
         return { comm_result, voltages };
     }
+    /**
+     * @brief reads only voltages at or above bitmap threshold, the rest of pins are reported as 0
+     */
+    [[nodiscard]] std::pair<Result, std::optional<AllPinsVoltages8B>> GetAllPinsVoltagesBitmap(int retry_times = 0) noexcept
+    {
+        auto [comm_result, bitmap] =
+          SendCmdAndReadResponse<BitmapReadoutCmd::BitmapT>(static_cast<Byte>(Command::GetPinVoltage),
+                                                            CommandArgT{ VoltageCheckCmd::SpecialMeasurements::MeasureAllBitmap },
+                                                            VoltageCheckCmd::timeToWaitForResponseAllPinsMs,
+                                                            retry_times);
+
+        if (comm_result != Result::Good) {
+            console.LogError("Reading pins voltages bitmap unsuccessful");
+            return { comm_result, std::nullopt };
+        }
+
+        AllPinsVoltages8B voltages{};
+        auto              set_pins_num = static_cast<size_t>(__builtin_popcount(*bitmap));
+
+        // bitmap and voltages are separate transactions, corrupted bitmap would map voltages to wrong pins
+        if (set_pins_num > pinCount or (pinCount < 32 and (*bitmap >> pinCount) != 0)) {
+            console.LogError("Pins voltages bitmap has pins which board does not have");
+            return { Result::BadAnswerFormat, std::nullopt };
+        }
+
+        if (set_pins_num == 0)
+            return { comm_result, voltages };
+
+        auto [read_result, set_pins_voltages] = dataLink.ReadBoardAnswer(set_pins_num);
+        if (read_result != DataLink::Result::Good) {
+            console.LogError("Reading voltages of pins set in bitmap unsuccessful");
+            return { Result::BadCommunication, std::nullopt };
+        }
+
+        if (set_pins_voltages->size() != set_pins_num) {
+            console.LogError("Number of voltages " + std::to_string(set_pins_voltages->size()) +
+                             " does not match number of pins set in bitmap " + std::to_string(set_pins_num));
+            return { Result::BadAnswerFormat, std::nullopt };
+        }
+
+        auto voltage_it = set_pins_voltages->cbegin();
+        for (auto pin = 0; pin < pinCount; pin++) {
+            if ((*bitmap & (BitmapReadoutCmd::BitmapT{ 1 } << pin)) == 0)
+                continue;
+
+            // board sets only pins at or above threshold, lower voltage means answer is not aligned with bitmap
+            if (bitmapThreshold != std::nullopt and *voltage_it < *bitmapThreshold) {
+                console.LogError("Voltage of pin " + std::to_string(pin) + " set in bitmap is below threshold");
+                return { Result::BadAnswerFormat, std::nullopt };
+            }
+
+            voltages[pin] = *voltage_it++;
+        }
+
+        return { comm_result, voltages };
+    }
+    /**
+     * @brief reads all pins with full ADC resolution. Boards with firmware supporting batched readout send all values
+     * packed in one transaction, older boards are read pin by pin.
+     */
+    [[nodiscard]] std::pair<Result, std::optional<AllPinsVoltages>> GetAllPinsVoltagesHiRes(int retry_times = 0) noexcept
+    {
+        if (not SupportsHiResReadout()) {
+            AllPinsVoltages voltages{};
+
+            for (auto pin = 0; pin < pinCount; pin++) {
+                auto [comm_result, voltage] = GetPinVoltage(pin, retry_times);
+
+                if (comm_result != Result::Good)
+                    return { comm_result, std::nullopt };
+
+                voltages[pin] = *voltage;
+            }
+
+            return { Result::Good, voltages };
+        }
+
+        auto [comm_result, packed_voltages] =
+          SendCmdAndReadResponse<AllPinsVoltagesPacked>(static_cast<Byte>(Command::GetPinVoltage),
+                                                        CommandArgT{ VoltageCheckCmd::SpecialMeasurements::MeasureAllHiRes },
+                                                        VoltageCheckCmd::timeToWaitForResponseAllPinsHiResMs,
+                                                        retry_times);
+
+        if (comm_result != Result::Good) {
+            console.LogError("Reading all pins voltages in high resolution unsuccessful");
+            return { comm_result, std::nullopt };
+        }
+
+        return { comm_result, UnpackHiResVoltages(*packed_voltages) };
+    }
     [[nodiscard]] std::pair<Result, std::optional<bool>> CheckFWVersionCompliance(int retry_times = 0) noexcept
     {
         auto res =
           SendCmdAndReadResponse<Byte>(GetFirmwareVersion::cmd, GetFirmwareVersion::delayForResponseMs, retry_times);
 
         if (res.first == Result::Good) {
-            if (res.second == GetFirmwareVersion::targetVersion)
+            firmwareVersion = *res.second;
+
+            // newer firmware only adds commands, so it stays compliant
+            if (*res.second >= GetFirmwareVersion::targetVersion)
                 return { res.first, true };
             else
                 return { res.first, false };
@@ -460,13 +663,50 @@ class Board {
     //getters: result obtained immediately from this
     [[nodiscard]] bool          IsHealthy() const noexcept { return isHealthy; }
     [[nodiscard]] bool          OutputIsEnabled() const noexcept { return outputIsEnabled; }
+    [[nodiscard]] PinNumT       GetEnabledOutputPin() const noexcept { return enabledOutputPin; }
     [[nodiscard]] OutputVoltage GetOutputVoltageLevel() const noexcept { return outputVoltageLevel; }
+    [[nodiscard]] FirmwareVersionT GetFirmwareVersionValue() const noexcept { return firmwareVersion; }
+    [[nodiscard]] bool             SupportsHiResReadout() const noexcept
+    {
+        return firmwareVersion >= FirmwareFeatures::hiResReadoutSinceVersion;
+    }
+    [[nodiscard]] bool SupportsBitmapReadout() const noexcept
+    {
+        return firmwareVersion >= FirmwareFeatures::bitmapReadoutSinceVersion;
+    }
     [[nodiscard]] std::shared_ptr<Semaphore> Get_MeasureAllTaskStart_Semaphore() const noexcept
     {
         return measureAllTaskStart_Semaphore;
     }
     [[nodiscard]] AddressT                   GetAddress() const noexcept { return dataLink.GetAddress(); }
 
+    // reset handling
+    /**
+     * @brief sends again to board all the settings which are lost after its restart
+     */
+    Result RestoreStateAfterReset(int retry_times = 0) noexcept
+    {
+        auto result = SetOutputVoltageValue(outputVoltageLevel, retry_times);
+        if (result != Result::Good) {
+            console.LogError("Output voltage level restoration unsuccessful");
+            return result;
+        }
+
+        if (bitmapThreshold != std::nullopt) {
+            result = SetBitmapThreshold(*bitmapThreshold, retry_times);
+            if (result != Result::Good)
+                return result;
+        }
+
+        if (outputIsEnabled) {
+            result = SetVoltageAtPin(enabledOutputPin, retry_times);
+            if (result != Result::Good)
+                console.LogError("Enabled output restoration unsuccessful");
+        }
+
+        return result;
+    }
+
     // tests
     bool StartTest(int retry_times = 0) noexcept
     {
@@ -592,7 +832,9 @@ class Board {
 
             {
                 voltageMeasurementMutex->lock();
-                auto [comm_result, voltages] = GetAllPinsVoltages();
+                auto [comm_result, voltages] = (readoutMode == ReadoutMode::Bitmap and SupportsBitmapReadout())
+                                                 ? GetAllPinsVoltagesBitmap()
+                                                 : GetAllPinsVoltages();
 
                 if (comm_result != Result::Good) {
                     allPinsVoltagesTableQueue->Send(
@@ -647,4 +889,9 @@ class Board {
     OutputVoltage      outputVoltageLevel  = OutputVoltage::_07;
     bool               isHealthy{ true };
     bool               outputIsEnabled{ false };
+    PinNumT            enabledOutputPin{};
+    FirmwareVersionT   firmwareVersion = GetFirmwareVersion::targetVersion;
+
+    std::atomic<ReadoutMode>     readoutMode{ ReadoutMode::FullTable };
+    std::optional<AdcValueLoRes> bitmapThreshold;
 };
\ No newline at end of file
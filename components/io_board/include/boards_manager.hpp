@@ -1,8 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "board.hpp"
+#include "boards_table.hpp"
+#include "wiggle_statistics.hpp"
+#include "sequential_connectivity_test.hpp"
+#include "acquisition_cache.hpp"
+#include "netlist_builder.hpp"
 #include "data_link.hpp"
 // #include "esp_logger.hpp"
 #include "iic.hpp"
@@ -22,7 +29,9 @@ class Apparatus {
     using Byte               = uint8_t;
     using BoardAddrT         = Byte;
     using OneBoardVoltages   = Board::OneBoardVoltages;
+    using OneBoardVoltagesHiRes = AllBoardsVoltagesHiRes::OneBoardVoltagesHiRes;
     using OutputVoltageLevel = Board::OutputVoltage;
+    using ReadoutMode        = Board::ReadoutMode;
     using QueueT             = Queue<OneBoardVoltages>;
     using PinNumT            = Board::PinNumT;
     using CircuitParamT      = float;
@@ -32,6 +41,30 @@ class Apparatus {
     using CommandCatcher     = CommandInterpreter<Bluetooth>;
     using UserCommand        = typename CommandCatcher::UserCommand;
     using CommunicatorT      = Communicator<MessageToMaster>;
+    using RequestIdT         = MessageFromMaster::RequestIdT;
+    using PinsBatch          = MessageFromMaster::Command::CheckPinsBatch;
+    using BoardPins          = PinsBatch::BoardPins;
+    using PinsMaskT          = PinsBatch::PinsMaskT;
+    using BoardsScan         = MessageFromMaster::Command::ScanBoards;
+    using WiggleTestCmd      = MessageFromMaster::Command::WiggleTest;
+    using Oversampling       = MessageFromMaster::Command::SetOversampling;
+
+    /**
+     * @brief how scan ended: paused scan is kept and may be resumed, rejected scan was not started at all
+     */
+    enum class ScanOutcome : Byte {
+        Completed = 0,
+        Cancelled,
+        Paused,
+        Rejected
+    };
+
+    auto static constexpr allPinsMask = static_cast<PinsMaskT>((uint64_t{ 1 } << Board::pinCount) - 1);
+    auto static constexpr defaultOversampling =
+      Oversampling{ 1,
+                    ProjCfg::BoardsConfigs::OversamplingConfidenceSteps,
+                    ProjCfg::BoardsConfigs::OversamplingDecisionLevel,
+                    ProjCfg::BoardsConfigs::OversamplingClearLevel };
 
     void static Create(std::shared_ptr<CommunicatorT> socket) noexcept
     {
@@ -53,6 +86,8 @@ class Apparatus {
     [[nodiscard]] bool                                    BoardsSearchPerformed() const noexcept { return boardsSearchPerformed; }
     std::optional<std::vector<Board::Info>> GetBoards(bool perform_rescan = false) noexcept
     {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
         if (perform_rescan) {
             FindAllConnectedBoards();
         }
@@ -63,17 +98,17 @@ class Apparatus {
         std::vector<Board::Info> v;
         v.reserve(ioBoards.size());
 
-        for (const auto &board : ioBoards) {
-            auto internals = board->GetInternalParameters(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        for (auto &board : ioBoards) {
+            auto internals = board.GetInternalParameters(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
 
             if (internals.second == std::nullopt) {
                 console.LogError("Unsuccessful internal parameters retrieval for board " +
-                                 std::to_string(board->GetAddress()));
+                                 std::to_string(board.GetAddress()));
                 return std::nullopt;
             }
 
             if (internals.second->outputResistance1 == UINT16_MAX) {
-                console.LogError("Board with address " + std::to_string(board->GetAddress()) +
+                console.LogError("Board with address " + std::to_string(board.GetAddress()) +
                                  " has not set internal parameters!");
 
                 internals.second->outputResistance1 = Board::GetInternalParametersCmd::STD_OUT_R;
@@ -86,16 +121,27 @@ class Apparatus {
             }
 
             v.emplace_back(Board::Info{ *internals.second,
-                                        board->GetAddress(),
-                                        Board::GetFirmwareVersion::targetVersion,
-                                        board->GetOutputVoltageLevel(),
-                                        board->IsHealthy() });
+                                        board.GetAddress(),
+                                        board.GetFirmwareVersionValue(),
+                                        board.GetOutputVoltageLevel(),
+                                        board.IsHealthy() });
         }
 
         return v;
     }
+    /**
+     * @brief answered from acquisition cache if the same was measured within freshness window under the same outputs
+     */
     std::optional<AllBoardsVoltages> MeasureAll() noexcept
     {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        auto drive_state = CurrentDriveState();
+        if (auto cached_voltages = acquisitionCache.Find(drive_state, NowMs())) {
+            console.Log("MeasureAll answered from cache");
+            return AllBoardsVoltages(std::move(*cached_voltages));
+        }
+
         auto voltages = GetAllVoltages(true);
         if (voltages == std::nullopt) {
             for (int retry_counter = 0; retry_counter < ProjCfg::FailHandle::GetAllVoltagesRetryTimes; retry_counter++) {
@@ -113,22 +159,333 @@ class Apparatus {
             return std::nullopt;
         }
 
+        acquisitionCache.Store(std::move(drive_state), *voltages, NowMs());
         return AllBoardsVoltages(std::move(*voltages));
     }
-    void CheckAllConnections() noexcept { FindAndAnalyzeAllConnections(ConnectionAnalysis::Raw, true); }
-    void CheckConnection(Board::PinAffinityAndId pin) noexcept
+    /**
+     * @brief same as MeasureAll but with full ADC resolution, boards are read one after another
+     */
+    std::optional<AllBoardsVoltagesHiRes> MeasureAllHiRes() noexcept
     {
-        FindConnectionsForPinAtBoard(pin.pinId, pin.boardAddress, ConnectionAnalysis::Raw, true);
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        std::vector<OneBoardVoltagesHiRes> boards_voltages;
+        boards_voltages.reserve(ioBoards.size());
+
+        for (auto &board : ioBoards) {
+            auto [comm_result, voltages] = board.GetAllPinsVoltagesHiRes(ProjCfg::FailHandle::GetAllVoltagesRetryTimes);
+
+            if (comm_result != CommResult::Good) {
+                console.LogError("High resolution voltages retrieval failed for board " +
+                                 std::to_string(board.GetAddress()));
+                return std::nullopt;
+            }
+
+            boards_voltages.push_back(OneBoardVoltagesHiRes{ board.GetAddress(), *voltages });
+        }
+
+        return AllBoardsVoltagesHiRes(std::move(boards_voltages));
+    }
+    /**
+     * @param request_id of command which started the scan, echoed in all results of the scan
+     * @return Completed, Paused if scan was paused and kept for resumption or Cancelled if it was cancelled
+     */
+    ScanOutcome CheckAllConnections(RequestIdT request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+        PlanAllBoardsScan(context);
+
+        return StartScan(context);
+    }
+    /**
+     * @brief full scan which sends no per pin results, whole result is sent as one Netlist when scan completes
+     */
+    ScanOutcome CheckAllConnectionsAsNetlist(bool       with_voltages,
+                                             RequestIdT request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context            = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+        context.collectNetlist  = true;
+        context.netlistVoltages = with_voltages;
+        PlanAllBoardsScan(context);
+
+        return StartScan(context);
+    }
+    /**
+     * @brief checks listed pins as one scan with single completion, pins of the same board are merged and boards are
+     * visited in address order
+     */
+    ScanOutcome CheckPinsBatch(PinsBatch const &batch,
+                               RequestIdT       request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+
+        for (size_t idx = 0; idx < batch.boardsNumber; idx++) {
+            auto const entry = batch.Entry(idx);
+            AddToScanPlan(context, entry.boardAddress, entry.pinsMask);
+        }
+
+        return StartScan(context);
+    }
+    /**
+     * @brief scan of fixture connected to part of boards: only pin ranges of drive boards are driven and only read
+     * boards are read, other boards are not touched during the scan
+     */
+    ScanOutcome ScanBoards(BoardsScan const &scan,
+                           RequestIdT        request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context = PlanBoardsScan(scan, request_id);
+        return StartScan(context);
+    }
+    /**
+     * @brief repeats scan of boards back to back until cancelled, only connections which appeared or disappeared since
+     * previous sweep are sent to master
+     */
+    ScanOutcome MonitorBoards(BoardsScan const &scan,
+                              RequestIdT        request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context       = PlanBoardsScan(scan, request_id);
+        context.monitoring = true;
+        return StartScan(context);
+    }
+    /**
+     * @brief samples read boards in a tight loop while driving selected pins one after another until cancelled. Master
+     * gets periodic summaries of statistics kept on device instead of samples. Single driven pin is set only once, so
+     * loop consists of readings only.
+     * @return Completed when cancelled by master, Rejected if driven or read boards are not present, Cancelled if test
+     * was aborted because driven pins could not be sampled
+     */
+    ScanOutcome WiggleTest(WiggleTestCmd const &test,
+                           RequestIdT           request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        if (pausedScan != std::nullopt) {
+            console.Log("Wiggle test started, paused scan is dropped");
+            pausedScan = std::nullopt;
+        }
+
+        auto context     = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+        auto driven_pins = std::vector<Board::PinAffinityAndId>(test.drivenPins.begin(),
+                                                                test.drivenPins.begin() + test.drivenPinsNumber);
+
+        AssignBoardsToRead(context, test.readBoards.begin(), test.readBoards.begin() + test.readBoardsNumber);
+
+        {
+            std::lock_guard<Mutex> bus_lock{ busMutex };
+
+            // sampling of absent board fails without bus transfer, test loop would spin without blocking
+            for (auto const &driven_pin : driven_pins) {
+                if (ioBoards.Find(driven_pin.boardAddress) == nullptr) {
+                    console.LogError("Wiggle test rejected, driven board " + std::to_string(driven_pin.boardAddress) +
+                                     " is not present");
+                    FinishScan(context, ScanOutcome::Rejected);
+                    return ScanOutcome::Rejected;
+                }
+            }
+
+            auto const read_boards_requested = not context.boardsToRead.empty();
+            auto       absent_boards_begin   = std::remove_if(
+              context.boardsToRead.begin(), context.boardsToRead.end(), [this](BoardAddrT address) {
+                  if (ioBoards.Find(address) != nullptr)
+                      return false;
+
+                  console.LogError("Read board " + std::to_string(address) + " is not present, skipped");
+                  return true;
+              });
+            context.boardsToRead.erase(absent_boards_begin, context.boardsToRead.end());
+
+            if (read_boards_requested and context.boardsToRead.empty()) {
+                console.LogError("Wiggle test rejected, none of read boards is present");
+                FinishScan(context, ScanOutcome::Rejected);
+                return ScanOutcome::Rejected;
+            }
+
+            for (auto &board : ioBoards) {
+                board.DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+            }
+            acquisitionCache.Invalidate();
+
+            if (context.boardsToRead.empty())
+                context.boardsToRead = ioBoards.Addresses();
+        }
+
+        auto       statistics        = WiggleStatistics(driven_pins.size());
+        auto const summary_period_ms = std::max<uint32_t>(test.summaryPeriodMs,
+                                                          ProjCfg::BoardsConfigs::WiggleMinSummaryPeriodMs);
+        auto       last_summary_ms   = NowMs();
+        auto       output_is_set     = false;
+        auto       failed_passes     = 0;
+
+        activeScan     = &context;
+        scanInProgress = true;
+        PublishScanProgress(DeviceStatus::State::Scanning, context);
+
+        while (not ScanMustStop(context)) {
+            auto pass_failed = true;
+
+            for (size_t pin_idx = 0; pin_idx < driven_pins.size(); pin_idx++) {
+                auto const sampled = SampleWigglePin(driven_pins, pin_idx, output_is_set, statistics, context);
+                output_is_set      = sampled and driven_pins.size() == 1;
+                pass_failed        = pass_failed and not sampled;
+                if (not sampled)
+                    context.pinFailures++;
+            }
+
+            // failed samples may take no bus time, so failing test must not keep command task busy
+            if (pass_failed) {
+                failed_passes++;
+                if (failed_passes >= ProjCfg::BoardsConfigs::WiggleMaxFailedPasses) {
+                    console.LogError("Wiggle test aborted, driven pins can not be sampled");
+                    context.stopRequest = StopRequest::Cancel;
+                    break;
+                }
+
+                Task::DelayMs(ProjCfg::BoardsConfigs::WiggleFailedPassDelayMs);
+            }
+            else {
+                failed_passes = 0;
+            }
+
+            if (NowMs() - last_summary_ms >= summary_period_ms) {
+                last_summary_ms = NowMs();
+                socket->Send(context.requestId, statistics.MakeSummary(driven_pins).Serialize());
+                PublishScanProgress(DeviceStatus::State::Scanning, context);
+            }
+        }
+
+        if (context.stopRequest == StopRequest::Pause)
+            console.Log("Wiggle test can not be paused, it is stopped");
+
+        DisableOutput();
+        scanInProgress = false;
+        activeScan     = nullptr;
+
+        socket->Send(context.requestId, statistics.MakeSummary(driven_pins).Serialize());
+        PublishScanProgress(DeviceStatus::State::Idle, context);
+
+        auto const outcome = failed_passes >= ProjCfg::BoardsConfigs::WiggleMaxFailedPasses ? ScanOutcome::Cancelled
+                                                                                            : ScanOutcome::Completed;
+        FinishScan(context, outcome);
+        return outcome;
+    }
+    /**
+     * @brief continues paused scan from the first pin which was not completed, results keep request id of the command
+     * which started the scan
+     * @return nullopt if there is no paused scan, otherwise how resumed scan ended
+     */
+    std::optional<ScanOutcome> ResumeScan() noexcept
+    {
+        if (pausedScan == std::nullopt) {
+            console.LogError("There is no paused scan to resume");
+            return std::nullopt;
+        }
+
+        auto context = std::move(*pausedScan);
+        pausedScan   = std::nullopt;
+
+        context.stopRequest = StopRequest::None;
+        return RunScan(context);
+    }
+    bool CheckConnection(Board::PinAffinityAndId pin,
+                         RequestIdT              request_id = MessageFromMaster::untaggedRequestId) noexcept
+    {
+        auto context         = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+        context.oversampling = oversampling;
+        context.useCache     = true;
+        return FindConnectionsForPinAtBoard(pin.pinId, pin.boardAddress, context);
+    }
+    /**
+     * @brief oversampling settings are taken by scans started after this call
+     */
+    void SetOversampling(Oversampling const &settings) noexcept
+    {
+        console.Log("Oversampling: up to " + std::to_string(settings.maxSamples) + " samples, " +
+                    std::to_string(settings.confidenceSteps) + " confidence steps");
+        oversampling = settings;
+        acquisitionCache.Invalidate();
+    }
+    /**
+     * @param window_ms how long measurements stay valid for MeasureAll and single pin checks, 0 disables the cache
+     */
+    void SetCacheWindow(uint32_t window_ms) noexcept
+    {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        console.Log("Acquisition cache window: " + std::to_string(window_ms) + "ms");
+        acquisitionCache.SetFreshnessWindow(window_ms);
+    }
+    /**
+     * @brief executes commands from control lane, invoked between pin steps of running scan and by command manager
+     * while idle. Must be called from command manager task only.
+     */
+    void ProcessControlCommands() noexcept
+    {
+        using ID = MessageFromMaster::Command::ID;
+
+        while (auto msg = controlCommandsQ->Receive(0)) {
+            socket->Acknowledge(*msg);
+
+            switch (msg->GetCommandID()) {
+            case ID::CancelScan: {
+                console.Log("Control: cancel scan");
+
+                auto scan_exists = activeScan != nullptr or pausedScan != std::nullopt;
+                if (activeScan != nullptr)
+                    activeScan->stopRequest = StopRequest::Cancel;
+                if (pausedScan != std::nullopt)
+                    FinishScan(*pausedScan, ScanOutcome::Cancelled);
+                pausedScan = std::nullopt;
+
+                if (msg->IsTagged())
+                    socket->ReportCompletion(*msg, scan_exists);
+            } break;
+            case ID::PauseScan: {
+                console.Log("Control: pause scan");
+
+                if (activeScan != nullptr)
+                    activeScan->stopRequest = StopRequest::Pause;
+
+                if (msg->IsTagged())
+                    socket->ReportCompletion(*msg, activeScan != nullptr);
+            } break;
+            case ID::DisableOutput: {
+                // output of running scan would be enabled again on its next step
+                if (activeScan != nullptr)
+                    activeScan->stopRequest = StopRequest::Cancel;
+
+                DisableOutput();
+
+                if (msg->IsTagged())
+                    socket->ReportCompletion(*msg, true);
+            } break;
+            case ID::GetStatus: {
+                auto status = DeviceStatus(DeviceStatus::State::Idle);
+                if (activeScan != nullptr)
+                    status = ScanStatus(DeviceStatus::State::Scanning, *activeScan);
+                else if (pausedScan != std::nullopt)
+                    status = ScanStatus(DeviceStatus::State::Paused, *pausedScan);
+
+                socket->Send(msg->GetRequestId(), status.Serialize());
+            } break;
+
+            default:
+                console.LogError("Not a control command: " + std::to_string(ToUnderlying(msg->GetCommandID())));
+                break;
+            }
+        }
     }
     void EnableOutputForPin(BoardAddrT board_addr, PinNumT pin) noexcept
     {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
         auto board = FindBoardWithAddress(board_addr);
-        if (board == std::nullopt) {
+        if (board == nullptr) {
             console.LogError("board with addr:" + std::to_string(board_addr) + " not found");
             return;
         }
 
-        auto result = (*board)->SetVoltageAtPin(pin);
+        // cached tables were taken before the line was driven, so they are stale even when outputs are restored
+        acquisitionCache.Invalidate();
+
+        auto result = board->SetVoltageAtPin(pin);
         if (result == CommResult::Good) {
             console.Log("Voltage at pin: " + std::to_string(pin) + " was set");
         }
@@ -146,15 +503,19 @@ class Apparatus {
      * @param forcedDisable : true: sends to all available boards command to disable output despite state of output
      *                                  stored inside Board class
      */
-    void DisableOutput(bool forcedDisable = false) const noexcept
+    void DisableOutput(bool forcedDisable = false) noexcept
     {
-        for (const auto &board : ioBoards) {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        acquisitionCache.Invalidate();
+
+        for (auto &board : ioBoards) {
             if (forcedDisable) {
-                board->DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+                board.DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
             }
             else {
-                if (board->OutputIsEnabled())
-                    board->DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+                if (board.OutputIsEnabled())
+                    board.DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
             }
         }
     }
@@ -166,6 +527,50 @@ class Apparatus {
         Resistance,
         Raw
     };
+    enum class StopRequest : Byte {
+        None = 0,
+        Cancel,
+        Pause
+    };
+    /**
+     * @brief parameters, stop request and position of one connections scan, passed through all of its steps. Scan
+     * stopped by pause request is kept as checkpoint and continued from stored position.
+     */
+    struct ScanContext {
+        ConnectionAnalysis analysisType = ConnectionAnalysis::Raw;
+        bool               sequential   = true;
+        RequestIdT         requestId    = MessageFromMaster::untaggedRequestId;
+
+        StopRequest  stopRequest  = StopRequest::None;
+        Oversampling oversampling = defaultOversampling;
+        bool         useCache     = false;
+
+        std::vector<BoardPins>  boardsToScan;
+        std::vector<BoardAddrT> boardsToRead;   // empty when all boards are read
+        size_t                  boardIndex  = 0;
+        PinNumT                 nextPin     = 0;
+        std::vector<PinNumT>    failedPins;
+        std::vector<PinNumT>    failedAgainPins;
+        int                     retriesLeft = ProjCfg::BoardsConfigs::PinConnectionsCheckRetryCount;
+
+        BoardAddrT currentBoard  = 0;
+        PinNumT    currentPin    = 0;
+        uint16_t   pinsCompleted = 0;
+        uint16_t   pinsTotal     = 0;
+        uint16_t   pinFailures   = 0;
+
+        // continuous monitoring, connections of every pin of plan are kept as one bit per pin of every read board
+        bool                   monitoring      = false;
+        uint32_t               sweepsCompleted = 0;
+        uint16_t               pinsChecked     = 0;   // pins of current sweep checked successfully
+        int                    failedSweeps    = 0;
+        std::vector<PinsMaskT> lastConnectivity;
+
+        // connections are collected into netlist sent at completion instead of being sent for every pin
+        bool           collectNetlist  = false;
+        bool           netlistVoltages = false;
+        NetlistBuilder netlist;
+    };
     struct SetPinVoltageCmd {
         enum SpecialPinConfigurations : Byte {
             DisableAll = 254
@@ -184,11 +589,12 @@ class Apparatus {
         auto constexpr start_address = 0x01;
         auto constexpr last_address  = 0x7F;
 
-        ioBoards.clear();
+        ioBoards.Clear();
+        acquisitionCache.Invalidate();
 
         Task::DelayMs(50);
 
-        auto seq_mutex = std::make_shared<Mutex>();
+        std::vector<BoardAddrT> found_addresses;
 
         for (auto addr = start_address; addr <= last_address; addr++) {
             auto board_found = i2c->CheckIfSlaveWithAddressIsOnLine(addr);
@@ -196,47 +602,114 @@ class Apparatus {
 
             if (board_found) {
                 console.Log("board with address:" + std::to_string(addr) + " was found");
-                ioBoards.emplace_back(std::make_shared<Board>(addr, pinsVoltagesResultsQ, seq_mutex));
-                boardsSemaphores.push_back(ioBoards.back()->Get_MeasureAllTaskStart_Semaphore());
+                found_addresses.push_back(addr);
             }
         }
 
-        if (ioBoards.size() == 0)
+        if (found_addresses.size() == 0)
             console.LogError("No boards found, check was performed between addresses: " + std::to_string(start_address) +
                              " and " + std::to_string(last_address));
 
         Task::DelayMs(ProjCfg::BoardsConfigs::DelayBeforeCheckOfInternalCounterAfterInitializationMs);
 
-        int board_counter = 0;
-        for (auto const &board : ioBoards) {
-            auto [comm_result, counter_value] =
-              board->GetBoardCounterValue(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
-            board->SetOutputVoltageValue(OutputVoltageLevel::_07, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
-
-            auto result = board->CheckFWVersionCompliance(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
-            if (result.first == CommResult::BadCommunication) {
-                console.LogError("Board with address " + std::to_string(board->GetAddress()) +
-                                 " has problems with communication!");
-                ioBoards.erase(ioBoards.begin() + board_counter);
-            }
-            else if (result.first == CommResult::Good) {
-                if (result.second == false) {
-                    console.LogError("Board with address " + std::to_string(board->GetAddress()) +
-                                     " has not compliant firmware version!");
-
-                    ioBoards.erase(ioBoards.begin() + board_counter);
-                }
-            }
-            else if (result.first == CommResult::BadAcknowledge) {
-                console.LogError("Board with address " + std::to_string(board->GetAddress()) +
-                                 " has no implemented GetFirmwareAddress command");
-            }
+        for (auto const addr : found_addresses) {
+            auto board = SetupBoard(addr);
 
-            board_counter++;
+            if (board != nullptr)
+                AddBoard(std::move(board));
         }
 
         boardsSearchPerformed = true;
     }
+    /**
+     * @brief creates board and brings it to known state
+     * @return nullptr if board can not be used: it does not communicate or its firmware is not compliant
+     */
+    std::unique_ptr<Board> SetupBoard(BoardAddrT addr) noexcept
+    {
+        auto board = std::make_unique<Board>(addr, pinsVoltagesResultsQ, sequentialRunMutex);
+
+        board->SetOutputVoltageValue(OutputVoltageLevel::_07, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+
+        auto result = board->CheckFWVersionCompliance(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+
+        if (board->SupportsBitmapReadout())
+            board->SetBitmapThreshold(ProjCfg::BoardsConfigs::ConnectivityThreshold,
+                                      ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+
+        if (result.first == CommResult::BadCommunication) {
+            console.LogError("Board with address " + std::to_string(addr) + " has problems with communication!");
+            return nullptr;
+        }
+        else if (result.first == CommResult::Good) {
+            if (result.second == false) {
+                console.LogError("Board with address " + std::to_string(addr) + " has not compliant firmware version!");
+                return nullptr;
+            }
+        }
+        else if (result.first == CommResult::BadAcknowledge) {
+            console.LogError("Board with address " + std::to_string(addr) +
+                             " has no implemented GetFirmwareAddress command");
+        }
+
+        return board;
+    }
+    void AddBoard(std::unique_ptr<Board> board) noexcept
+    {
+        auto addr = board->GetAddress();
+
+        ioBoards.Insert(std::move(board));
+        acquisitionCache.Invalidate();
+
+        auto [comm_result, counter_value] =
+          ioBoards.Find(addr)->GetBoardCounterValue(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        if (counter_value != std::nullopt)
+            ioBoards.StateOf(addr).RegisterCounterValue(*counter_value);
+    }
+    void RemoveBoard(BoardAddrT board_address) noexcept
+    {
+        // board's task must not be deleted in the middle of measurement
+        sequentialRunMutex->lock();
+        ioBoards.Erase(board_address);
+        sequentialRunMutex->unlock();
+
+        acquisitionCache.Invalidate();
+    }
+    /**
+     * @brief checks part of addresses not occupied by known boards, so that boards connected to working device are
+     * found without full rescan
+     * @return addresses of boards added
+     */
+    std::vector<BoardAddrT> ProbeUnclaimedAddresses(int addresses_to_probe) noexcept
+    {
+        std::vector<BoardAddrT> added_boards;
+
+        for (; addresses_to_probe > 0; addresses_to_probe--) {
+            auto addr = nextAddressToProbe;
+
+            nextAddressToProbe++;
+            if (nextAddressToProbe > ProjCfg::BoardsConfigs::MaxAddress)
+                nextAddressToProbe = ProjCfg::BoardsConfigs::MinAddress;
+
+            if (ioBoards.Find(addr) != nullptr)
+                continue;
+
+            if (not i2c->CheckIfSlaveWithAddressIsOnLine(addr))
+                continue;
+
+            console.Log("new board with address:" + std::to_string(addr) + " was found");
+            Task::DelayMs(ProjCfg::BoardsConfigs::DelayBeforeCheckOfInternalCounterAfterInitializationMs);
+
+            auto board = SetupBoard(addr);
+            if (board == nullptr)
+                continue;
+
+            AddBoard(std::move(board));
+            added_boards.push_back(addr);
+        }
+
+        return added_boards;
+    }
     void SendAllBoardsIds() noexcept
     {
         // todo: clenup this function
@@ -244,8 +717,8 @@ class Apparatus {
 
         std::string response = "HW dummyarg -> ";
 
-        for (auto board : ioBoards) {
-            response.append(std::to_string(board->GetAddress()) + ' ');
+        for (auto const board_address : ioBoards.Addresses()) {
+            response.append(std::to_string(board_address) + ' ');
         }
 
         response.append("END\n");
@@ -254,44 +727,149 @@ class Apparatus {
     }
     void SetOutputVoltageValue(OutputVoltageLevel level) noexcept
     {
-        for (auto const &board : ioBoards) {
+        acquisitionCache.Invalidate();
+
+        for (auto &board : ioBoards) {
             console.Log("Setting voltage level");
-            auto result = board->SetOutputVoltageValue(level, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+            auto result = board.SetOutputVoltageValue(level, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
 
             if (result != CommResult::Good) {
                 Task::DelayMs(100);
-                board->SetOutputVoltageValue(level, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+                board.SetOutputVoltageValue(level, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
             }
 
             Task::DelayMs(10);
         }
     }
 
-    bool FindConnectionsForPinAtBoard(PinNumT                pin,
-                                      std::shared_ptr<Board> board,
-                                      ConnectionAnalysis     analysis_type,
-                                      bool                   sequential)
+    /**
+     * @brief drives the pin, reads boards and disables the output again, bus must be locked by caller
+     * @param connected_boards_hi_res if given, boards with pins connected to driven pin are read again with full
+     * resolution while pin is still driven
+     */
+    std::optional<std::vector<OneBoardVoltages>> AcquireWithPinDriven(
+      PinNumT                             pin,
+      Board                              &board,
+      ScanContext const                  &context,
+      std::vector<OneBoardVoltagesHiRes> *connected_boards_hi_res = nullptr) noexcept
     {
-        auto result = board->SetVoltageAtPin(pin, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        acquisitionCache.Invalidate();
+
+        auto result = board.SetVoltageAtPin(pin, ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
         if (result != CommResult::Good) {
             console.LogError("Setting pin voltage unsuccessful");
-            return false;
+            return std::nullopt;
         }
 
         Task::DelayMs(ProjCfg::BoardsConfigs::DelayAfterPinVoltageSetMs);
 
-        auto voltage_tables_from_all_boards = GetAllVoltages(sequential);
-        if (board->DisableOutput(ProjCfg::BoardsConfigs::DisableOutputRetryTimes) != CommResult::Good) {
+        // only presence of voltage matters for connections, so boards capable of that send just pins above threshold
+        auto voltage_tables_from_all_boards =
+          GetAllVoltages(context.sequential, ReadoutMode::Bitmap, context.boardsToRead);
+        if (voltage_tables_from_all_boards != std::nullopt and context.oversampling.maxSamples > 1)
+            ResolveReadingsNearThreshold(*voltage_tables_from_all_boards, context);
+        if (voltage_tables_from_all_boards != std::nullopt and connected_boards_hi_res != nullptr and
+            not ReadConnectedBoardsHiRes(*voltage_tables_from_all_boards, *connected_boards_hi_res))
+            voltage_tables_from_all_boards = std::nullopt;
+
+        if (board.DisableOutput(ProjCfg::BoardsConfigs::DisableOutputRetryTimes) != CommResult::Good) {
             console.LogError("Disable output unsuccessful");
-            return false;
+            return std::nullopt;
         }
 
-        if (voltage_tables_from_all_boards == std::nullopt) {
+        if (voltage_tables_from_all_boards == std::nullopt)
             console.LogError("Voltage tables not obtained!");
-            return false;
+
+        return voltage_tables_from_all_boards;
+    }
+    /**
+     * @brief repeated check of the same pin under the same outputs within freshness window is answered from cache
+     */
+    std::optional<std::vector<OneBoardVoltages>> AcquireWithPinDrivenCached(PinNumT            pin,
+                                                                            Board             &board,
+                                                                            ScanContext const &context) noexcept
+    {
+        auto drive_state         = CurrentDriveState();
+        drive_state.hasDrivenPin = true;
+        drive_state.drivenBoard  = board.GetAddress();
+        drive_state.drivenPin    = pin;
+
+        if (auto cached_voltages = acquisitionCache.Find(drive_state, NowMs())) {
+            console.Log("Pin check answered from cache");
+            return cached_voltages;
+        }
+
+        auto voltage_tables = AcquireWithPinDriven(pin, board, context);
+        if (voltage_tables != std::nullopt)
+            acquisitionCache.Store(std::move(drive_state), *voltage_tables, NowMs());
+
+        return voltage_tables;
+    }
+    /**
+     * @brief must be called with bus locked
+     */
+    AcquisitionCache::DriveState CurrentDriveState() const noexcept
+    {
+        auto state = AcquisitionCache::DriveState{};
+        state.boards.reserve(ioBoards.size());
+
+        for (auto const &board : ioBoards) {
+            state.boards.push_back(AcquisitionCache::BoardDrive{ board.GetAddress(),
+                                                                 board.OutputIsEnabled(),
+                                                                 board.GetEnabledOutputPin(),
+                                                                 board.GetOutputVoltageLevel() });
+        }
+
+        return state;
+    }
+    /**
+     * @brief boards which have at least one pin with voltage, bus must be locked by caller
+     * @return false if any of them could not be read
+     */
+    bool ReadConnectedBoardsHiRes(std::vector<OneBoardVoltages> const &voltage_tables,
+                                  std::vector<OneBoardVoltagesHiRes>  &hi_res_tables) noexcept
+    {
+        for (auto const &table : voltage_tables) {
+            auto const has_connections = std::any_of(
+              table.pinsVoltages.begin(), table.pinsVoltages.end(), [](auto voltage) { return voltage > 0; });
+            if (not has_connections)
+                continue;
+
+            auto board = FindBoardWithAddress(table.boardAddress);
+            if (not board)
+                return false;
+
+            auto [comm_result, voltages] =
+              board->GetAllPinsVoltagesHiRes(ProjCfg::FailHandle::GetAllVoltagesRetryTimes);
+            if (comm_result != CommResult::Good) {
+                console.LogError("High resolution voltages retrieval failed for board " +
+                                 std::to_string(table.boardAddress));
+                return false;
+            }
+
+            hi_res_tables.push_back(OneBoardVoltagesHiRes{ table.boardAddress, *voltages });
         }
 
+        return true;
+    }
+    bool FindConnectionsForPinAtBoard(PinNumT pin, Board &board, ScanContext &context)
+    {
+        // resistance is calculated from full resolution readings, 8 bit sweep only finds boards which need them
+        std::vector<OneBoardVoltagesHiRes> connected_boards_hi_res;
+
+        auto voltage_tables_from_all_boards =
+          context.analysisType == ConnectionAnalysis::Resistance
+            ? AcquireWithPinDriven(pin, board, context, &connected_boards_hi_res)
+            : (context.useCache ? AcquireWithPinDrivenCached(pin, board, context)
+                                : AcquireWithPinDriven(pin, board, context));
+        if (voltage_tables_from_all_boards == std::nullopt)
+            return false;
+
+        if (context.monitoring)
+            return ReportConnectivityChanges(pin, board, *voltage_tables_from_all_boards, context);
+
         std::string response_header;
+        auto const analysis_type = context.analysisType;
         switch (analysis_type) {
         case ConnectionAnalysis::SimpleBoolean: response_header = "CONNECT"; break;
         case ConnectionAnalysis::Voltage: response_header = "VOLTAGES"; break;
@@ -304,24 +882,30 @@ class Apparatus {
         }
         }
 
-        std::string answer_to_master = response_header + ' ' + std::to_string(board->GetAddress()) + ':' +
+        std::string answer_to_master = response_header + ' ' + std::to_string(board.GetAddress()) + ':' +
                                        std::to_string(Board::GetHarnessPinNumFromLogicPinNum(pin)) + " -> ";
 
         using ConnectionData = PinConnectivity::PinConnectionData;
         using PinDescriptor  = PinConnectivity::PinAffinityAndId;
 
         auto master_pin =
-          PinDescriptor{ board->GetAddress(), static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(pin)) };
+          PinDescriptor{ board.GetAddress(), static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(pin)) };
         std::vector<ConnectionData> cons{};
 
         for (const auto &voltage_table_from_board : *voltage_tables_from_all_boards) {
             std::string board_affinity = std::to_string(voltage_table_from_board.boardAddress);
+            // present for every board with connections when analysis is Resistance
+            auto hi_res_table = std::find_if(connected_boards_hi_res.begin(),
+                                             connected_boards_hi_res.end(),
+                                             [&voltage_table_from_board](OneBoardVoltagesHiRes const &table) {
+                                                 return table.boardAddress == voltage_table_from_board.boardAddress;
+                                             });
 
             auto pin_counter = 0;
             for (auto voltage : voltage_table_from_board.pinsVoltages) {
                 auto harness_pin_id = Board::GetHarnessPinNumFromLogicPinNum(pin_counter);
 
-                if (pin == pin_counter and board->GetAddress() == voltage_table_from_board.boardAddress) {
+                if (pin == pin_counter and board.GetAddress() == voltage_table_from_board.boardAddress) {
                     if (voltage == 0) {
                         console.LogError("Pin is not connected to itself!");
                         return false;
@@ -335,7 +919,8 @@ class Apparatus {
                     else if (analysis_type == ConnectionAnalysis::Resistance) {
                         answer_to_master.append(board_affinity + ':' + std::to_string(harness_pin_id) + '(' +
                                                 StringParser::ConvertFpValueWithPrecision(
-                                                  board->CalculateConnectionResistanceFromAdcValue(voltage),
+                                                  board.CalculateConnectionResistanceFromAdcValue(
+                                                    hi_res_table->pinsVoltages[pin_counter]),
                                                   1) +
                                                 ") ");
                     }
@@ -361,78 +946,439 @@ class Apparatus {
 
         console.Log(answer_to_master);
 
-        if (not socket->GetToMasterSB()->Send(PinConnectivity(std::move(master_pin), std::move(cons)).Serialize())) {
-            console.LogError("Unsuccessful send to streambuffer! Pin: " + std::to_string(board->GetAddress()) + ":" +
+        if (context.collectNetlist) {
+            for (auto const &connection : cons)
+                context.netlist.AddConnection(master_pin, connection.affinityAndId, connection.connectionVoltageLvl);
+
+            return true;
+        }
+
+        auto connectivity = PinConnectivity(std::move(master_pin), std::move(cons)).Serialize();
+        if (not socket->Send(context.requestId, connectivity)) {
+            console.LogError("Unsuccessful send to streambuffer! Pin: " + std::to_string(board.GetAddress()) + ":" +
                              std::to_string(pin));
         }
         //        Task::DelayMs(3);
 
         return true;
     }
-    void FindConnectionsForPinAtBoard(PinNumT            pin,
-                                      BoardAddrT         board_address,
-                                      ConnectionAnalysis analysis_type,
-                                      bool               sequential)
+    /**
+     * @brief compares connections of driven pin with the ones found by previous sweep and sends only the difference
+     */
+    bool ReportConnectivityChanges(PinNumT                              pin,
+                                   Board                               &board,
+                                   std::vector<OneBoardVoltages> const &voltage_tables,
+                                   ScanContext                         &context) noexcept
+    {
+        auto const connected_pins_of = [](OneBoardVoltages const &table) {
+            auto connected = PinsMaskT{ 0 };
+            for (size_t pin_idx = 0; pin_idx < table.pinsVoltages.size(); pin_idx++) {
+                if (table.pinsVoltages[pin_idx] > 0)
+                    connected |= PinsMaskT{ 1 } << pin_idx;
+            }
+            return connected;
+        };
+
+        // faulty measurement must not be stored as state
+        for (auto const &table : voltage_tables) {
+            auto const is_driven_board = table.boardAddress == board.GetAddress();
+            if (is_driven_board and (connected_pins_of(table) & (PinsMaskT{ 1 } << pin)) == 0) {
+                console.LogError("Pin is not connected to itself!");
+                return false;
+            }
+        }
+
+        auto const driven_pin_idx = context.boardIndex * Board::pinCount + pin;
+        auto       changes        = std::vector<ConnectivityChanges::Change>{};
+
+        for (auto const &table : voltage_tables) {
+            auto read_board =
+              std::lower_bound(context.boardsToRead.begin(), context.boardsToRead.end(), table.boardAddress);
+            if (read_board == context.boardsToRead.end() or *read_board != table.boardAddress)
+                continue;
+
+            auto      &last_connected = context.lastConnectivity[driven_pin_idx * context.boardsToRead.size() +
+                                                            std::distance(context.boardsToRead.begin(), read_board)];
+            auto const connected      = connected_pins_of(table);
+
+            for (auto changed = connected ^ last_connected; changed != 0; changed &= changed - 1) {
+                auto const changed_pin = __builtin_ctz(changed);
+                changes.push_back(ConnectivityChanges::Change{
+                  Board::PinAffinityAndId{ table.boardAddress,
+                                           static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(changed_pin)) },
+                  (connected & (PinsMaskT{ 1 } << changed_pin)) != 0 });
+            }
+
+            last_connected = connected;
+        }
+
+        if (changes.empty())
+            return true;
+
+        auto driven_pin = Board::PinAffinityAndId{ board.GetAddress(),
+                                                   static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(pin)) };
+        auto message =
+          ConnectivityChanges(NowMs(), context.sweepsCompleted, driven_pin, std::move(changes)).Serialize();
+
+        if (not socket->Send(context.requestId, message))
+            console.LogError("Unsuccessful send of connectivity changes! Pin: " + std::to_string(board.GetAddress()) +
+                             ":" + std::to_string(pin));
+
+        return true;
+    }
+    /**
+     * @param output_is_set true if driven pin is still enabled by previous sample, output is left enabled only when
+     * there is single driven pin
+     */
+    bool SampleWigglePin(std::vector<Board::PinAffinityAndId> const &driven_pins,
+                         size_t                                      pin_idx,
+                         bool                                        output_is_set,
+                         WiggleStatistics                           &statistics,
+                         ScanContext                                &context) noexcept
+    {
+        auto const &driven_pin = driven_pins[pin_idx];
+
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        auto board = FindBoardWithAddress(driven_pin.boardAddress);
+        if (not board)
+            return false;
+
+        if (not output_is_set) {
+            acquisitionCache.Invalidate();
+
+            if (board->SetVoltageAtPin(driven_pin.pinId, ProjCfg::FailHandle::CommandToBoardAttemptsNumber) !=
+                CommResult::Good)
+                return false;
+
+            Task::DelayMs(ProjCfg::BoardsConfigs::DelayAfterPinVoltageSetMs);
+        }
+
+        auto voltage_tables = GetAllVoltages(context.sequential, ReadoutMode::FullTable, context.boardsToRead);
+
+        if (driven_pins.size() > 1 and
+            board->DisableOutput(ProjCfg::BoardsConfigs::DisableOutputRetryTimes) != CommResult::Good)
+            console.LogError("Disable output unsuccessful");
+
+        if (voltage_tables == std::nullopt)
+            return false;
+
+        statistics.AddSample(pin_idx, *voltage_tables, NowMs());
+        context.currentBoard = driven_pin.boardAddress;
+        context.currentPin   = driven_pin.pinId;
+        context.pinsCompleted++;
+
+        return true;
+    }
+    /**
+     * @brief boards which have pins with readings close to threshold are read again while driven pin is still enabled,
+     * until sequential test decides every pin or samples limit is reached. Clear readings cost no extra samples.
+     */
+    void ResolveReadingsNearThreshold(std::vector<OneBoardVoltages> &voltage_tables,
+                                      ScanContext const             &context) noexcept
+    {
+        auto test = SequentialConnectivityTest(context.oversampling, voltage_tables);
+
+        for (auto samples = 1; samples < context.oversampling.maxSamples; samples++) {
+            auto const undecided_boards = test.UndecidedBoards();
+            if (undecided_boards.empty())
+                break;
+
+            auto extra_sample = GetAllVoltages(context.sequential, ReadoutMode::Bitmap, undecided_boards);
+            if (extra_sample == std::nullopt)
+                break;
+
+            test.AddSample(*extra_sample);
+        }
+
+        test.ApplyDecisions(voltage_tables);
+    }
+    bool FindConnectionsForPinAtBoard(PinNumT pin, BoardAddrT board_address, ScanContext &context)
     {
         if (pin > Board::pinCount) {
             console.LogError("requested pin number is higher than pin count at one board, requested pin: " +
                              std::to_string(pin));
-            return;
+            return false;
         }
 
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        // board is looked up on every step as monitor task may remove it between steps
         auto board = FindBoardWithAddress(board_address);
         if (not board) {
             console.LogError("Board with address: " + std::to_string(board_address) + " not found");
-            return;
+            return false;
         }
 
-        FindConnectionsForPinAtBoard(pin, *board, analysis_type, sequential);
+        return FindConnectionsForPinAtBoard(pin, *board, context);
     }
-    void FindAndAnalyzeAllConnectionsForBoard(std::shared_ptr<Board> board,
-                                              ConnectionAnalysis     analysis_type,
-                                              bool                   sequential)
+    /**
+     * @brief continues scan of one board from position stored in context
+     * @return false if scan was stopped, context then points to the first pin which was not completed
+     */
+    bool FindAndAnalyzeAllConnectionsForBoard(BoardPins const &target, ScanContext &context)
     {
         constexpr auto pin_count_at_board = Board::pinCount;
-        int            retry_count        = ProjCfg::BoardsConfigs::PinConnectionsCheckRetryCount;
 
-        std::vector<PinNumT> failedPins;
+        auto const board     = target.boardAddress;
+        context.currentBoard = board;
+
+        for (; context.nextPin < pin_count_at_board; context.nextPin++) {
+            if ((target.pinsMask & (PinsMaskT{ 1 } << context.nextPin)) == 0)
+                continue;
+
+            if (ScanMustStop(context))
+                return false;
 
-        for (PinNumT pin = 0; pin < pin_count_at_board; pin++) {
-            if (not FindConnectionsForPinAtBoard(pin, board, analysis_type, sequential)) {
-                failedPins.emplace_back(pin);
+            context.currentPin = context.nextPin;
+            if (FindConnectionsForPinAtBoard(context.nextPin, board, context)) {
+                context.pinsChecked++;
+            }
+            else {
+                context.failedPins.emplace_back(context.nextPin);
+                context.pinFailures++;
             }
+            context.pinsCompleted++;
+            PublishScanProgress(DeviceStatus::State::Scanning, context);
         }
 
-        if (failedPins.empty())
-            return;
-
-        do {
-            std::vector<PinNumT> failedPinsSecondTime;
+        while (context.retriesLeft > 0 and not context.failedPins.empty()) {
+            while (not context.failedPins.empty()) {
+                if (ScanMustStop(context))
+                    return false;
 
-            for (auto const pin : failedPins) {
-                if (not FindConnectionsForPinAtBoard(pin, board, analysis_type, sequential)) {
-                    failedPinsSecondTime.emplace_back(pin);
+                auto const pin     = context.failedPins.front();
+                context.currentPin = pin;
+                if (FindConnectionsForPinAtBoard(pin, board, context)) {
+                    context.pinsChecked++;
                 }
-            }
+                else {
+                    context.failedAgainPins.emplace_back(pin);
+                    context.pinFailures++;
+                }
+                PublishScanProgress(DeviceStatus::State::Scanning, context);
 
-            failedPins = std::move(failedPinsSecondTime);
+                context.failedPins.erase(context.failedPins.begin());
+            }
 
-            retry_count--;
-        } while (retry_count > 0);
+            std::swap(context.failedPins, context.failedAgainPins);
+            context.retriesLeft--;
+        }
 
-        return;
+        return true;
+    }
+    /**
+     * @brief control lane is served between pin steps, so control commands are not delayed by the scan
+     * @return true if scan has to be stopped
+     */
+    bool ScanMustStop(ScanContext &context) noexcept
+    {
+        ProcessControlCommands();
+        return context.stopRequest != StopRequest::None;
     }
-    void FindAndAnalyzeAllConnections(ConnectionAnalysis analysis_type, bool sequential) noexcept
+    void FindAndAnalyzeAllConnections(ScanContext &context) noexcept
     {
         console.Log("Executing command: FindAndAnalyzeAllConnections");
 
-        for (auto board : ioBoards) {
-            board->DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        for (; context.boardIndex < context.boardsToScan.size(); context.boardIndex++) {
+            if (not FindAndAnalyzeAllConnectionsForBoard(context.boardsToScan[context.boardIndex], context))
+                return;
+
+            context.nextPin     = 0;
+            context.retriesLeft = ProjCfg::BoardsConfigs::PinConnectionsCheckRetryCount;
+            context.failedPins.clear();
+        }
+    }
+    void PlanAllBoardsScan(ScanContext &context) noexcept
+    {
+        std::lock_guard<Mutex> bus_lock{ busMutex };
+
+        // boards may be added or removed by monitor task between pin steps, scan is performed on snapshot
+        for (auto const address : ioBoards.Addresses())
+            context.boardsToScan.push_back(BoardPins{ address, allPinsMask });
+    }
+    ScanContext PlanBoardsScan(BoardsScan const &scan, RequestIdT request_id) noexcept
+    {
+        auto context = ScanContext{ ConnectionAnalysis::Raw, true, request_id };
+
+        if (scan.driveBoardsNumber == 0)
+            PlanAllBoardsScan(context);
+
+        for (size_t idx = 0; idx < scan.driveBoardsNumber; idx++) {
+            auto const &range      = scan.driveBoards[idx];
+            auto const  range_mask = static_cast<PinsMaskT>(((uint64_t{ 1 } << (range.lastPin + 1)) - 1) &
+                                                           ~((uint64_t{ 1 } << range.firstPin) - 1));
+
+            AddToScanPlan(context, range.boardAddress, range_mask);
+        }
+
+        AssignBoardsToRead(context, scan.readBoards.begin(), scan.readBoards.begin() + scan.readBoardsNumber);
+
+        return context;
+    }
+    /**
+     * @brief read boards are kept sorted and unique, so every board is read once per sample
+     */
+    template<typename AddressIterator>
+    static void AssignBoardsToRead(ScanContext &context, AddressIterator begin, AddressIterator end) noexcept
+    {
+        context.boardsToRead.assign(begin, end);
+        std::sort(context.boardsToRead.begin(), context.boardsToRead.end());
+        context.boardsToRead.erase(std::unique(context.boardsToRead.begin(), context.boardsToRead.end()),
+                                   context.boardsToRead.end());
+    }
+    /**
+     * @brief adds pins of board to scan plan which is kept sorted by board address, pins of the same board are merged
+     */
+    static void AddToScanPlan(ScanContext &context, BoardAddrT board_address, PinsMaskT pins_mask) noexcept
+    {
+        auto board = std::lower_bound(context.boardsToScan.begin(),
+                                      context.boardsToScan.end(),
+                                      board_address,
+                                      [](BoardPins const &target, BoardAddrT address) {
+                                          return target.boardAddress < address;
+                                      });
+
+        if (board != context.boardsToScan.end() and board->boardAddress == board_address)
+            board->pinsMask |= pins_mask & allPinsMask;
+        else
+            context.boardsToScan.insert(board, BoardPins{ board_address, pins_mask & allPinsMask });
+    }
+    /**
+     * @brief drops paused scan, disables outputs and removes boards which are not present from the plan of new scan
+     */
+    ScanOutcome StartScan(ScanContext &context) noexcept
+    {
+        context.oversampling = oversampling;
+
+        if (pausedScan != std::nullopt) {
+            console.Log("New scan started, paused scan is dropped");
+            pausedScan = std::nullopt;
+        }
+
+        {
+            std::lock_guard<Mutex> bus_lock{ busMutex };
+
+            for (auto &board : ioBoards) {
+                board.DisableOutput(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+            }
+            acquisitionCache.Invalidate();
+
+            auto absent_boards_begin =
+              std::remove_if(context.boardsToScan.begin(), context.boardsToScan.end(), [this](BoardPins const &target) {
+                  if (ioBoards.Find(target.boardAddress) != nullptr)
+                      return false;
+
+                  console.LogError("Board " + std::to_string(target.boardAddress) + " is not present, skipped");
+                  return true;
+              });
+            context.boardsToScan.erase(absent_boards_begin, context.boardsToScan.end());
+
+            // monitoring state is indexed by read board, so set of read boards is fixed at start
+            if (context.monitoring and context.boardsToRead.empty())
+                context.boardsToRead = ioBoards.Addresses();
+        }
+
+        if (context.monitoring)
+            context.lastConnectivity.assign(
+              context.boardsToScan.size() * Board::pinCount * context.boardsToRead.size(), PinsMaskT{ 0 });
+
+        for (auto const &target : context.boardsToScan)
+            context.pinsTotal += __builtin_popcount(target.pinsMask);
+
+        return RunScan(context);
+    }
+    ScanOutcome RunScan(ScanContext &context) noexcept
+    {
+        activeScan     = &context;
+        scanInProgress = true;
+        PublishScanProgress(DeviceStatus::State::Scanning, context);
+
+        FindAndAnalyzeAllConnections(context);
+        while (context.monitoring and context.stopRequest == StopRequest::None and StartNextSweep(context))
+            FindAndAnalyzeAllConnections(context);
+
+        scanInProgress = false;
+        activeScan     = nullptr;
+        PublishScanProgress(context.stopRequest == StopRequest::Pause ? DeviceStatus::State::Paused
+                                                                      : DeviceStatus::State::Idle,
+                            context);
+
+        switch (context.stopRequest) {
+        case StopRequest::Pause:
+            console.Log("Connections scan paused at board " + std::to_string(context.currentBoard) + " pin " +
+                        std::to_string(context.currentPin));
+            pausedScan = std::move(context);
+            return ScanOutcome::Paused;
+        case StopRequest::Cancel: FinishScan(context, ScanOutcome::Cancelled); return ScanOutcome::Cancelled;
+        default: FinishScan(context, ScanOutcome::Completed); return ScanOutcome::Completed;
+        }
+    }
+    /**
+     * @brief sweep in which no pin was checked takes no bus time when driven boards are gone, so next sweep is
+     * delayed and monitoring is stopped after MonitoringMaxFailedSweeps such sweeps in a row
+     * @return false if there is nothing to monitor
+     */
+    bool StartNextSweep(ScanContext &context) noexcept
+    {
+        if (context.boardsToScan.empty())
+            return false;
+
+        if (context.pinsChecked == 0) {
+            context.failedSweeps++;
+            if (context.failedSweeps >= ProjCfg::BoardsConfigs::MonitoringMaxFailedSweeps) {
+                console.LogError("Monitoring stopped, no pin could be checked in " +
+                                 std::to_string(context.failedSweeps) + " sweeps");
+                context.stopRequest = StopRequest::Cancel;
+                return false;
+            }
+
+            Task::DelayMs(ProjCfg::BoardsConfigs::MonitoringFailedSweepDelayMs);
         }
+        else {
+            context.failedSweeps = 0;
+        }
+
+        context.sweepsCompleted++;
+        context.boardIndex    = 0;
+        context.nextPin       = 0;
+        context.pinsCompleted = 0;
+        context.pinsChecked   = 0;
+        context.retriesLeft   = ProjCfg::BoardsConfigs::PinConnectionsCheckRetryCount;
+        context.failedPins.clear();
 
-        for (auto board : ioBoards) {
-            FindAndAnalyzeAllConnectionsForBoard(board, analysis_type, sequential);
+        return true;
+    }
+    /**
+     * @brief master is informed that tagged scan will produce no more results
+     */
+    void FinishScan(ScanContext const &context, ScanOutcome outcome) noexcept
+    {
+        if (outcome == ScanOutcome::Cancelled)
+            console.Log("Connections scan cancelled");
+
+        if (outcome == ScanOutcome::Completed and context.collectNetlist) {
+            if (not socket->Send(context.requestId, context.netlist.MakeNetlist(context.netlistVoltages).Serialize()))
+                console.LogError("Unsuccessful send of netlist!");
         }
+
+        if (context.requestId != MessageFromMaster::untaggedRequestId)
+            socket->ReportCompletion(context.requestId, outcome == ScanOutcome::Completed);
+    }
+    void PublishScanProgress(DeviceStatus::State state, ScanContext const &context) noexcept
+    {
+        socket->PublishScanProgress(ScanProgress{ state,
+                                                  context.requestId,
+                                                  context.currentBoard,
+                                                  static_cast<Byte>(context.currentPin),
+                                                  context.pinsCompleted,
+                                                  context.pinsTotal,
+                                                  context.pinFailures });
+    }
+    static uint32_t     NowMs() noexcept { return xTaskGetTickCount() * portTICK_PERIOD_MS; }
+    static DeviceStatus ScanStatus(DeviceStatus::State state, ScanContext const &context) noexcept
+    {
+        return DeviceStatus(state, context.requestId, context.currentBoard, context.currentPin, context.pinsCompleted);
     }
     void GetBoardCounter(BoardAddrT board_addr)
     {
@@ -442,8 +1388,7 @@ class Apparatus {
             return;
         }
 
-        auto [comm_result, counter_value] =
-          (*board)->GetBoardCounterValue(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        auto [comm_result, counter_value] = board->GetBoardCounterValue(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
         std::string response_string;
 
         if (comm_result == CommResult::Good) {
@@ -453,14 +1398,72 @@ class Apparatus {
 
         console.Log(response_string);
     }
-    std::optional<std::vector<OneBoardVoltages>> GetAllVoltages(bool sequential) noexcept
+    /**
+     * @brief reads internal counters of all boards in one sweep: the command is sent to every board first and responses
+     * are collected after single wait. Boards which counter went backwards were restarted, their state is restored.
+     * Boards which did not answer several times in a row are considered disconnected and are removed.
+     * @return addresses of boards removed
+     */
+    std::vector<BoardAddrT> CheckBoardsLiveness() noexcept
+    {
+        std::vector<BoardAddrT> requested_boards;
+        std::vector<BoardAddrT> silent_boards;
+        requested_boards.reserve(ioBoards.size());
+
+        for (auto &board : ioBoards) {
+            if (board.RequestBoardCounterValue() == CommResult::Good)
+                requested_boards.push_back(board.GetAddress());
+            else
+                silent_boards.push_back(board.GetAddress());
+        }
+
+        if (not requested_boards.empty())
+            Task::DelayMs(Board::GetInternalCounter::delayBeforeResultCheck);
+
+        for (auto const addr : requested_boards) {
+            auto &board_state                 = ioBoards.StateOf(addr);
+            auto [comm_result, counter_value] = board_state.board->ReadBoardCounterValue();
+            if (comm_result != CommResult::Good) {
+                silent_boards.push_back(addr);
+                continue;
+            }
+
+            board_state.RegisterLivenessCheckResult(true);
+
+            if (board_state.RegisterCounterValue(*counter_value)) {
+                console.LogError("Board with address " + std::to_string(addr) + " was restarted, restoring its state");
+                board_state.board->RestoreStateAfterReset(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+                acquisitionCache.Invalidate();
+            }
+        }
+
+        std::vector<BoardAddrT> removed_boards;
+        for (auto const addr : silent_boards) {
+            if (ioBoards.StateOf(addr).RegisterLivenessCheckResult(false) <
+                ProjCfg::BoardsConfigs::MissedLivenessChecksBeforeRemoval)
+                continue;
+
+            console.LogError("Board with address " + std::to_string(addr) + " stopped answering, removing it");
+            RemoveBoard(addr);
+            removed_boards.push_back(addr);
+        }
+
+        return removed_boards;
+    }
+    /**
+     * @param boards_to_read boards to be measured, all boards are measured if empty
+     */
+    std::optional<std::vector<OneBoardVoltages>> GetAllVoltages(
+      bool                           sequential,
+      ReadoutMode                    readout_mode   = ReadoutMode::FullTable,
+      std::vector<BoardAddrT> const &boards_to_read = {}) noexcept
     {
         pinsVoltagesResultsQ->Flush();
-        StartVoltageMeasurementOnAllBoards(sequential);
+        auto const boards_measured = StartVoltageMeasurementOnBoards(sequential, readout_mode, boards_to_read);
 
         std::vector<OneBoardVoltages> all_boards_voltages;
 
-        for (auto board = 0; board < ioBoards.size(); board++) {
+        for (auto board = 0; board < boards_measured; board++) {
             auto voltage_table = pinsVoltagesResultsQ->Receive(pdMS_TO_TICKS(ProjCfg::TimeoutMs::VoltagesQueueReceive));
 
             if (voltage_table == std::nullopt) {
@@ -487,7 +1490,7 @@ class Apparatus {
             return;
         }
 
-        auto result = (*board)->GetInternalParameters(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
+        auto result = board->GetInternalParameters(ProjCfg::FailHandle::CommandToBoardAttemptsNumber);
         if (result.first != CommResult::Good)
             return;
 
@@ -502,24 +1505,32 @@ class Apparatus {
         console.Log(answer);
     }
     // helpers
-    std::optional<std::shared_ptr<Board>> FindBoardWithAddress(BoardAddrT board_address) noexcept
+    [[nodiscard]] Board *FindBoardWithAddress(BoardAddrT board_address) const noexcept
     {
-        auto board_it = std::find_if(ioBoards.begin(), ioBoards.end(), [board_address](auto board) {
-            return board->GetAddress() == board_address;
-        });
-
-        if (board_it == ioBoards.end()) {
-            //            console.LogError("No board found with address: " + std::to_string(board_address));
-            return std::nullopt;
-        }
-
-        return *board_it;
+        return ioBoards.Find(board_address);
     }
-    void StartVoltageMeasurementOnAllBoards(bool sequential)
+    /**
+     * @return number of boards which started measurement, boards which are not present are skipped
+     */
+    size_t StartVoltageMeasurementOnBoards(bool                           sequential,
+                                           ReadoutMode                    readout_mode,
+                                           std::vector<BoardAddrT> const &boards_to_read)
     {
-        for (auto const &semaphore : boardsSemaphores) {
-            semaphore->Give();
+        auto const &addresses      = boards_to_read.empty() ? ioBoards.Addresses() : boards_to_read;
+        auto        boards_started = size_t{ 0 };
+
+        for (auto const addr : addresses) {
+            if (ioBoards.Find(addr) == nullptr)
+                continue;
+
+            auto &board_state = ioBoards.StateOf(addr);
+
+            board_state.board->SetReadoutMode(readout_mode);
+            board_state.measurementStart->Give();
+            boards_started++;
         }
+
+        return boards_started;
     }
 
     // tests
@@ -530,9 +1541,9 @@ class Apparatus {
         int bad_pin     = -1;
         int bad_voltage = -1;
         while (true) {
-            ioBoards.at(0)->SetVoltageAtPin(pin);
+            ioBoards.Front().SetVoltageAtPin(pin);
             Task::DelayMs(3);
-            auto [comm_result, voltages] = ioBoards.at(0)->GetAllPinsVoltages();
+            auto [comm_result, voltages] = ioBoards.Front().GetAllPinsVoltages();
 
             if (comm_result != CommResult::Good) {
                 console.LogError("Bad result from getting all voltages!");
@@ -548,7 +1559,7 @@ class Apparatus {
     [[noreturn]] void UnitTestGetCounter() noexcept
     {
         while (true) {
-            auto [comm_result, counter] = ioBoards.at(0)->GetBoardCounterValue();
+            auto [comm_result, counter] = ioBoards.Front().GetBoardCounterValue();
 
             if (comm_result != CommResult::Good) {
                 console.LogError("Bad!");
@@ -564,7 +1575,7 @@ class Apparatus {
     {
         while (true) {
             for (auto pin_counter = 0; pin_counter < 32; pin_counter++) {
-                ioBoards.at(0)->SetVoltageAtPin(pin_counter);
+                ioBoards.Front().SetVoltageAtPin(pin_counter);
                 Task::DelayMs(500);
             }
         }
@@ -573,7 +1584,7 @@ class Apparatus {
     {
         while (true) {
             for (auto pin_counter = 0; pin_counter < 32; pin_counter++) {
-                auto [comm_result, pin_v] = ioBoards.at(0)->GetPinVoltage(pin_counter);
+                auto [comm_result, pin_v] = ioBoards.Front().GetPinVoltage(pin_counter);
 
                 if (comm_result != CommResult::Good) {
                     console.LogError("Bad");
@@ -588,7 +1599,7 @@ class Apparatus {
     [[noreturn]] void UnitTestTwoCommands() noexcept
     {
         while (true) {
-            auto [comm_result, voltages] = ioBoards.at(0)->GetAllPinsVoltages();
+            auto [comm_result, voltages] = ioBoards.Front().GetAllPinsVoltages();
 
             if (comm_result != CommResult::Good) {
                 console.LogError("Get All bad result!");
@@ -603,7 +1614,7 @@ class Apparatus {
 
             Task::DelayMs(500);
             for (auto pin_counter = 0; pin_counter < 32; pin_counter++) {
-                auto [comm_result, pin_v] = ioBoards.at(0)->GetPinVoltage(pin_counter);
+                auto [comm_result, pin_v] = ioBoards.Front().GetPinVoltage(pin_counter);
 
                 if (comm_result != CommResult::Good) {
                     console.LogError("Bad response at pin:" + std::to_string(pin_counter));
@@ -619,10 +1630,10 @@ class Apparatus {
     {
         auto constexpr test_data_len = 10;
 
-        if (!ioBoards.at(0)->StartTest())
+        if (!ioBoards.Front().StartTest())
             std::terminate();
 
-        auto board_addr = ioBoards.at(0)->GetAddress();
+        auto board_addr = ioBoards.Front().GetAddress();
 
         Task::DelayMs(200);
 
@@ -636,7 +1647,7 @@ class Apparatus {
             }
 
             Task::DelayMs(100);
-            auto [operation_result, result] = i2c->Read<decltype(data)>(ioBoards.at(0)->GetAddress(), 200);
+            auto [operation_result, result] = i2c->Read<decltype(data)>(ioBoards.Front().GetAddress(), 200);
 
             if (operation_result != IIC::OperationResult::OK) {
                 console.LogError("Unsuccessful read!");
@@ -652,6 +1663,34 @@ class Apparatus {
             Task::DelayMs(100);
         }
     }
+    // tasks
+    [[noreturn]] void BoardsMonitorTask() noexcept
+    {
+        while (true) {
+            Task::DelayMs(ProjCfg::BoardsConfigs::LivenessCheckPeriodMs);
+
+            std::vector<BoardAddrT> removed_boards;
+            std::vector<BoardAddrT> added_boards;
+
+            {
+                std::lock_guard<Mutex> bus_lock{ busMutex };
+
+                removed_boards = CheckBoardsLiveness();
+                if (not scanInProgress)
+                    added_boards = ProbeUnclaimedAddresses(ProjCfg::BoardsConfigs::AddressesProbedPerMonitorCycle);
+            }
+
+            if (added_boards.empty() and removed_boards.empty())
+                continue;
+
+            if (not socket->Send(
+                  BoardsSetChanged(std::move(added_boards), std::move(removed_boards)).Serialize(),
+                  ProjCfg::TimeoutMs::BoardsEventSend)) {
+                console.LogError("Unsuccessful send of boards set change to streambuffer!");
+            }
+        }
+    }
+
     void PrintAllVoltagesFromTable(std::vector<OneBoardVoltages> const &voltages_tables) noexcept
     {
         for (auto const &table : voltages_tables) {
@@ -669,7 +1708,9 @@ class Apparatus {
     Apparatus(std::shared_ptr<CommunicatorT> new_socket)
       : console{ "Main", ProjCfg::EnableLogForComponent::Main }
       , pinsVoltagesResultsQ{ std::make_shared<QueueT>(10) }
+      , sequentialRunMutex{ std::make_shared<Mutex>() }
       , socket{ std::move(new_socket) }
+      , controlCommandsQ{ socket->GetControlCommandsQ() }
     {
         IIC::Create(IIC::Role::Master,
                     ProjCfg::BoardsConfigs::SDA_Pin,
@@ -677,6 +1718,8 @@ class Apparatus {
                     ProjCfg::BoardsConfigs::IICSpeedHz);
         i2c = IIC::Get();
         Init();
+
+        boardsMonitorTask.Start();
     }
 
     std::shared_ptr<Apparatus> static _this;
@@ -684,11 +1727,27 @@ class Apparatus {
     Logger               console;
     std::shared_ptr<IIC> i2c = nullptr;
 
-    std::vector<std::shared_ptr<Board>>     ioBoards;
-    std::vector<std::shared_ptr<Semaphore>> boardsSemaphores;
-    std::shared_ptr<QueueT>                 pinsVoltagesResultsQ;
-
-    std::shared_ptr<CommunicatorT> socket;
-
-    bool boardsSearchPerformed{ false };
+    BoardsTable             ioBoards;
+    std::shared_ptr<QueueT> pinsVoltagesResultsQ;
+    std::shared_ptr<Mutex>  sequentialRunMutex;
+
+    std::shared_ptr<CommunicatorT>              socket;
+    std::shared_ptr<CommunicatorT::FromMasterQ> controlCommandsQ;
+
+    Mutex mutable busMutex;
+    Task          boardsMonitorTask{ [this]() { BoardsMonitorTask(); },
+                            ProjCfg::Tasks::BoardsMonitorStackSize,
+                            ProjCfg::Tasks::BoardsMonitorPrio,
+                            "BoardsMonitor",
+                            ProjCfg::Tasks::DefaultTasksCore,
+                            true };
+
+    bool              boardsSearchPerformed{ false };
+    std::atomic<bool> scanInProgress{ false };
+    BoardAddrT        nextAddressToProbe{ ProjCfg::BoardsConfigs::MinAddress };
+    ScanContext      *activeScan{ nullptr };
+    Oversampling      oversampling{ defaultOversampling };
+    AcquisitionCache  acquisitionCache;
+
+    std::optional<ScanContext> pausedScan;
 };
\ No newline at end of file
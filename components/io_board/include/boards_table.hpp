@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "board.hpp"
+
+/**
+ * @brief storage of boards indexed directly by board's address. Lookup is a single array index, compact bookkeeping
+ * state of every board is kept contiguously in one array, addresses of present boards are kept in a dense sorted list
+ * so iteration does not visit empty slots.
+ */
+class BoardsTable {
+  public:
+    using Byte             = uint8_t;
+    using AddressT         = Board::AddressT;
+    using InternalCounterT = Board::InternalCounterT;
+
+    auto static constexpr capacity = ProjCfg::BoardsConfigs::MaxAddress + 1;
+
+    struct BoardState {
+        /**
+         * @brief stores new value of board's internal counter
+         * @return true if counter went backwards since last check, which means that board was restarted and lost its
+         * state
+         */
+        bool RegisterCounterValue(InternalCounterT counter_value) noexcept
+        {
+            auto board_was_reset = counterValueIsKnown and counter_value < lastCounterValue;
+            lastCounterValue     = counter_value;
+            counterValueIsKnown  = true;
+
+            return board_was_reset;
+        }
+        /**
+         * @param answered true if board answered to liveness check
+         * @return number of liveness checks missed in a row
+         */
+        int RegisterLivenessCheckResult(bool answered) noexcept
+        {
+            if (answered)
+                missedLivenessChecks = 0;
+            else
+                missedLivenessChecks++;
+
+            return missedLivenessChecks;
+        }
+
+        Board           *board                = nullptr;
+        Semaphore       *measurementStart     = nullptr;
+        InternalCounterT lastCounterValue     = 0;
+        Byte             missedLivenessChecks = 0;
+        bool             counterValueIsKnown  = false;
+    };
+
+    class Iterator {
+      public:
+        using AddressIterator = std::vector<AddressT>::const_iterator;
+
+        Iterator(BoardsTable const *owner, AddressIterator address_it) noexcept
+          : table{ owner }
+          , addressIt{ address_it }
+        { }
+
+        Board    &operator*() const noexcept { return *table->states[*addressIt].board; }
+        Iterator &operator++() noexcept
+        {
+            ++addressIt;
+            return *this;
+        }
+        bool operator!=(Iterator const &rhs) const noexcept { return addressIt != rhs.addressIt; }
+
+      private:
+        BoardsTable const *table;
+        AddressIterator    addressIt;
+    };
+
+    [[nodiscard]] Board *Find(AddressT address) const noexcept
+    {
+        if (address >= capacity)
+            return nullptr;
+
+        return states[address].board;
+    }
+    [[nodiscard]] BoardState &StateOf(AddressT address) noexcept { return states[address]; }
+    [[nodiscard]] Board      &Front() const noexcept { return *states[addresses.front()].board; }
+
+    void Insert(std::unique_ptr<Board> board) noexcept
+    {
+        auto address = board->GetAddress();
+
+        if (Find(address) != nullptr)
+            Erase(address);
+
+        states[address]                  = BoardState{};
+        states[address].board            = board.get();
+        states[address].measurementStart = board->Get_MeasureAllTaskStart_Semaphore().get();
+        owners[address]                  = std::move(board);
+
+        addresses.insert(std::lower_bound(addresses.begin(), addresses.end(), address), address);
+    }
+    void Erase(AddressT address) noexcept
+    {
+        if (Find(address) == nullptr)
+            return;
+
+        addresses.erase(std::lower_bound(addresses.begin(), addresses.end(), address));
+        states[address] = BoardState{};
+        owners[address].reset();
+    }
+    void Clear() noexcept
+    {
+        for (auto const address : addresses) {
+            states[address] = BoardState{};
+            owners[address].reset();
+        }
+
+        addresses.clear();
+    }
+
+    [[nodiscard]] std::vector<AddressT> const &Addresses() const noexcept { return addresses; }
+    [[nodiscard]] size_t                       size() const noexcept { return addresses.size(); }
+    [[nodiscard]] bool                         empty() const noexcept { return addresses.empty(); }
+    [[nodiscard]] Iterator                     begin() const noexcept { return Iterator{ this, addresses.cbegin() }; }
+    [[nodiscard]] Iterator                     end() const noexcept { return Iterator{ this, addresses.cend() }; }
+
+  private:
+    std::array<BoardState, capacity>             states{};
+    std::array<std::unique_ptr<Board>, capacity> owners{};
+    std::vector<AddressT>                        addresses;
+};
@@ -78,6 +78,18 @@ class DataLink {
         else
             return {Result::BadCommunication, std::nullopt};
     }
+    /**
+     * @brief reads answer which length is known only at runtime
+     */
+    std::pair<Result, std::optional<std::vector<Byte>>> ReadBoardAnswer(size_t bytes_num) noexcept
+    {
+        auto retvalue = driver->Read(boardAddress, bytes_num, xferTimeout);
+
+        if (retvalue != std::nullopt)
+            return { Result::Good, std::move(retvalue) };
+        else
+            return { Result::BadCommunication, std::nullopt };
+    }
 
     std::optional<std::vector<Byte>> UnitTestCommunication(std::vector<Byte> const &data) noexcept
     {
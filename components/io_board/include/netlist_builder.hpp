@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "board.hpp"
+#include "message.hpp"
+
+/**
+ * @brief collects connections found during scan and turns them into one Netlist. Connection is kept once for pair of
+ * pins, in row of lower pin, no matter which of them was driven. If both directions were measured the higher voltage
+ * is kept.
+ */
+class NetlistBuilder {
+  public:
+    using Byte             = uint8_t;
+    using PinAffinityAndId = Board::PinAffinityAndId;
+    using Connection       = Netlist::Connection;
+
+    void AddConnection(PinAffinityAndId driven_pin, PinAffinityAndId connected_pin, Byte voltage) noexcept
+    {
+        auto const driven    = Netlist::NodeIndex(driven_pin);
+        auto const connected = Netlist::NodeIndex(connected_pin);
+
+        if (driven == connected)
+            return;
+
+        connections.push_back(Connection{ std::min(driven, connected), std::max(driven, connected), voltage });
+    }
+
+    [[nodiscard]] Netlist MakeNetlist(bool with_voltages) const noexcept
+    {
+        auto sorted = connections;
+        std::sort(sorted.begin(), sorted.end(), [](Connection const &lhs, Connection const &rhs) {
+            if (lhs.lowerPin != rhs.lowerPin)
+                return lhs.lowerPin < rhs.lowerPin;
+            if (lhs.higherPin != rhs.higherPin)
+                return lhs.higherPin < rhs.higherPin;
+            return lhs.voltage > rhs.voltage;
+        });
+
+        // duplicates are adjacent and the first one has the highest voltage
+        auto unique_end = std::unique(sorted.begin(), sorted.end(), [](Connection const &lhs, Connection const &rhs) {
+            return lhs.lowerPin == rhs.lowerPin and lhs.higherPin == rhs.higherPin;
+        });
+        sorted.erase(unique_end, sorted.end());
+
+        return Netlist{ std::move(sorted), with_voltages };
+    }
+
+  private:
+    std::vector<Connection> connections;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "board.hpp"
+#include "message.hpp"
+
+/**
+ * @brief sequential probability ratio test deciding connection of pins which readings are close to threshold. Every
+ * reading adds its log likelihood ratio in integer steps: clear readings (zero or at least clearLevel) move the sum by
+ * the whole decision limit and decide at once, readings between them move it by one step towards open or connected
+ * depending on decisionLevel. Pin is sampled again until its sum leaves (-confidenceSteps, confidenceSteps) or samples
+ * limit is reached. If every near threshold reading is right with probability p, wrong decision probability is about
+ * ((1 - p) / p) ^ confidenceSteps.
+ */
+class SequentialConnectivityTest {
+  public:
+    using Byte             = uint8_t;
+    using AddressT         = Board::AddressT;
+    using OneBoardVoltages = Board::OneBoardVoltages;
+    using Settings         = MessageFromMaster::Command::SetOversampling;
+
+    SequentialConnectivityTest(Settings const                      &test_settings,
+                               std::vector<OneBoardVoltages> const &first_sample) noexcept
+      : settings{ test_settings }
+    {
+        boards.reserve(first_sample.size());
+
+        for (auto const &table : first_sample) {
+            boards.push_back(BoardState{ table.boardAddress, {}, {} });
+            AddReadings(boards.back(), table);
+        }
+    }
+
+    /**
+     * @return addresses of boards which have at least one pin not decided yet
+     */
+    [[nodiscard]] std::vector<AddressT> UndecidedBoards() const noexcept
+    {
+        std::vector<AddressT> undecided;
+
+        for (auto const &board : boards) {
+            if (std::any_of(board.likelihood.begin(), board.likelihood.end(), [this](int sum) {
+                    return not IsDecided(sum);
+                }))
+                undecided.push_back(board.address);
+        }
+
+        return undecided;
+    }
+    void AddSample(std::vector<OneBoardVoltages> const &sample) noexcept
+    {
+        for (auto const &table : sample) {
+            auto board = std::find_if(boards.begin(), boards.end(), [&table](BoardState const &state) {
+                return state.address == table.boardAddress;
+            });
+
+            if (board != boards.end())
+                AddReadings(*board, table);
+        }
+    }
+    /**
+     * @brief replaces readings of first sample by decisions: pins decided open read zero, pins decided connected read
+     * the highest value seen. Pins not decided within samples limit are decided by sign of their sum.
+     */
+    void ApplyDecisions(std::vector<OneBoardVoltages> &first_sample) const noexcept
+    {
+        for (auto &table : first_sample) {
+            auto board = std::find_if(boards.begin(), boards.end(), [&table](BoardState const &state) {
+                return state.address == table.boardAddress;
+            });
+            if (board == boards.end())
+                continue;
+
+            for (size_t pin = 0; pin < table.pinsVoltages.size(); pin++)
+                table.pinsVoltages[pin] = (board->likelihood[pin] > 0) ? board->maxVoltage[pin] : 0;
+        }
+    }
+
+  private:
+    struct BoardState {
+        AddressT                          address;
+        std::array<int, Board::pinCount>  likelihood;
+        std::array<Byte, Board::pinCount> maxVoltage;
+    };
+
+    [[nodiscard]] bool IsDecided(int sum) const noexcept
+    {
+        return sum >= settings.confidenceSteps or sum <= -settings.confidenceSteps;
+    }
+    void AddReadings(BoardState &board, OneBoardVoltages const &table) noexcept
+    {
+        for (size_t pin = 0; pin < table.pinsVoltages.size(); pin++) {
+            if (IsDecided(board.likelihood[pin]))
+                continue;
+
+            auto const voltage = table.pinsVoltages[pin];
+
+            if (voltage == 0)
+                board.likelihood[pin] -= settings.confidenceSteps;
+            else if (voltage >= settings.clearLevel)
+                board.likelihood[pin] += settings.confidenceSteps;
+            else
+                board.likelihood[pin] += (voltage >= settings.decisionLevel) ? 1 : -1;
+
+            board.maxVoltage[pin] = std::max(board.maxVoltage[pin], voltage);
+        }
+    }
+
+    Settings                settings;
+    std::vector<BoardState> boards;
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "board.hpp"
+#include "message.hpp"
+
+/**
+ * @brief statistics of wiggle test kept on device for every pair of driven pin and pin connected to it. First sample of
+ * driven pin is its baseline, every later sample in which connection of pair differs from baseline is a glitch. Number
+ * of tracked pairs is bounded, pins which did not fit are followed as one connected bit per pin of every read board and
+ * only their transitions between connected and open are counted as untracked glitches.
+ */
+class WiggleStatistics {
+  public:
+    using Byte             = uint8_t;
+    using AddressT         = Board::AddressT;
+    using PinNumT          = Board::PinNumT;
+    using OneBoardVoltages = Board::OneBoardVoltages;
+    using PairStatistics   = WiggleSummary::PairStatistics;
+    using PinsMaskT        = uint32_t;
+    static_assert(Board::pinCount <= sizeof(PinsMaskT) * 8, "every pin of board must fit into mask");
+
+    explicit WiggleStatistics(size_t driven_pins_number) noexcept
+      : baselineIsTaken(driven_pins_number, false)
+    {
+        pairs.reserve(ProjCfg::BoardsConfigs::WiggleMaxPairs);
+    }
+
+    void AddSample(size_t                               driven_pin_idx,
+                   std::vector<OneBoardVoltages> const &voltage_tables,
+                   uint32_t                             timestamp_ms) noexcept
+    {
+        auto const is_baseline = not baselineIsTaken[driven_pin_idx];
+        samples++;
+
+        for (auto &pair : pairs) {
+            if (pair.drivenPinIdx != driven_pin_idx)
+                continue;
+
+            auto table = FindTable(voltage_tables, pair.board);
+            if (table == voltage_tables.end())
+                continue;
+
+            auto const voltage = table->pinsVoltages[pair.pin];
+            pair.minVoltage    = std::min(pair.minVoltage, voltage);
+            pair.maxVoltage    = std::max(pair.maxVoltage, voltage);
+
+            if ((voltage > 0) != pair.connectedAtBaseline)
+                pair.RegisterGlitch(timestamp_ms);
+        }
+
+        // pins connected for the first time become new pairs
+        for (auto const &table : voltage_tables) {
+            for (PinNumT pin = 0; pin < table.pinsVoltages.size(); pin++) {
+                auto const voltage = table.pinsVoltages[pin];
+                if (voltage == 0 or IsTracked(driven_pin_idx, table.boardAddress, pin))
+                    continue;
+
+                if (pairs.size() == ProjCfg::BoardsConfigs::WiggleMaxPairs)
+                    continue;
+
+                pairs.push_back(Pair{ driven_pin_idx,
+                                      table.boardAddress,
+                                      static_cast<Byte>(pin),
+                                      is_baseline,
+                                      static_cast<Byte>(is_baseline ? voltage : 0),
+                                      voltage });
+                if (not is_baseline)
+                    pairs.back().RegisterGlitch(timestamp_ms);
+            }
+        }
+
+        // first sample of board under driven pin is baseline of its untracked pins, stable connections do not count
+        for (auto const &table : voltage_tables) {
+            auto const connected = ConnectedPinsOf(table);
+            auto const tracked   = TrackedPinsOf(driven_pin_idx, table.boardAddress);
+            auto      &untracked = UntrackedPinsOf(driven_pin_idx, table.boardAddress, connected);
+            auto const changed   = (connected ^ untracked.connected) & ~tracked;
+
+            untrackedGlitches = static_cast<uint16_t>(
+              std::min<uint32_t>(untrackedGlitches + __builtin_popcount(changed), UINT16_MAX));
+            untracked.connected = connected;
+        }
+
+        baselineIsTaken[driven_pin_idx] = true;
+    }
+    /**
+     * @param driven_pins driven pins in the order of their indexes given to AddSample
+     */
+    WiggleSummary MakeSummary(std::vector<Board::PinAffinityAndId> const &driven_pins) noexcept
+    {
+        std::vector<PairStatistics> statistics;
+        statistics.reserve(pairs.size());
+
+        for (auto const &pair : pairs) {
+            auto const &driven_pin = driven_pins[pair.drivenPinIdx];
+
+            statistics.push_back(PairStatistics{
+              Board::PinAffinityAndId{ driven_pin.boardAddress,
+                                       static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(driven_pin.pinId)) },
+              Board::PinAffinityAndId{ pair.board,
+                                       static_cast<Byte>(Board::GetHarnessPinNumFromLogicPinNum(pair.pin)) },
+              pair.connectedAtBaseline,
+              pair.minVoltage,
+              pair.maxVoltage,
+              pair.glitches,
+              pair.firstGlitchMs,
+              pair.lastGlitchMs });
+        }
+
+        return WiggleSummary(summariesMade++, samples, untrackedGlitches, std::move(statistics));
+    }
+
+  private:
+    struct Pair {
+        void RegisterGlitch(uint32_t timestamp_ms) noexcept
+        {
+            if (glitches == 0)
+                firstGlitchMs = timestamp_ms;
+
+            lastGlitchMs = timestamp_ms;
+            if (glitches != UINT16_MAX)
+                glitches++;
+        }
+
+        size_t   drivenPinIdx;
+        AddressT board;
+        Byte     pin;
+        bool     connectedAtBaseline;
+        Byte     minVoltage;
+        Byte     maxVoltage;
+        uint16_t glitches      = 0;
+        uint32_t firstGlitchMs = 0;
+        uint32_t lastGlitchMs  = 0;
+    };
+
+    /**
+     * @brief last connectivity of pins of one read board under one driven pin, bits of tracked pins are ignored
+     */
+    struct UntrackedPins {
+        size_t    drivenPinIdx;
+        AddressT  board;
+        PinsMaskT connected;
+    };
+
+    using TableIterator = std::vector<OneBoardVoltages>::const_iterator;
+
+    static PinsMaskT ConnectedPinsOf(OneBoardVoltages const &table) noexcept
+    {
+        auto connected = PinsMaskT{ 0 };
+        for (PinNumT pin = 0; pin < table.pinsVoltages.size(); pin++) {
+            if (table.pinsVoltages[pin] > 0)
+                connected |= PinsMaskT{ 1 } << pin;
+        }
+
+        return connected;
+    }
+    [[nodiscard]] PinsMaskT TrackedPinsOf(size_t driven_pin_idx, AddressT board) const noexcept
+    {
+        auto tracked = PinsMaskT{ 0 };
+        for (auto const &pair : pairs) {
+            if (pair.drivenPinIdx == driven_pin_idx and pair.board == board)
+                tracked |= PinsMaskT{ 1 } << pair.pin;
+        }
+
+        return tracked;
+    }
+    /**
+     * @param connected stored as baseline if board is sampled under driven pin for the first time
+     */
+    UntrackedPins &UntrackedPinsOf(size_t driven_pin_idx, AddressT board, PinsMaskT connected) noexcept
+    {
+        auto entry = std::find_if(untrackedPins.begin(), untrackedPins.end(), [&](UntrackedPins const &candidate) {
+            return candidate.drivenPinIdx == driven_pin_idx and candidate.board == board;
+        });
+
+        if (entry != untrackedPins.end())
+            return *entry;
+
+        untrackedPins.push_back(UntrackedPins{ driven_pin_idx, board, connected });
+        return untrackedPins.back();
+    }
+
+    static TableIterator FindTable(std::vector<OneBoardVoltages> const &voltage_tables, AddressT board) noexcept
+    {
+        return std::find_if(voltage_tables.begin(), voltage_tables.end(), [board](OneBoardVoltages const &table) {
+            return table.boardAddress == board;
+        });
+    }
+    [[nodiscard]] bool IsTracked(size_t driven_pin_idx, AddressT board, PinNumT pin) const noexcept
+    {
+        return std::any_of(pairs.begin(), pairs.end(), [&](Pair const &pair) {
+            return pair.drivenPinIdx == driven_pin_idx and pair.board == board and pair.pin == pin;
+        });
+    }
+
+    std::vector<Pair>          pairs;
+    std::vector<UntrackedPins> untrackedPins;
+    std::vector<bool>          baselineIsTaken;
+    uint32_t                   samples{ 0 };
+    uint16_t                   untrackedGlitches{ 0 };
+    uint16_t                   summariesMade{ 0 };
+};
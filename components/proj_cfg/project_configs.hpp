@@ -27,7 +27,22 @@ enum BoardsConfigs {
     DelayAfterPinVoltageSetMs                              = 1,
     DelayBeforeReadAllPinsVoltagesResult                   = 11,
     DelayBeforeRetryCommandSendMs                          = 50,
-    DisableOutputRetryTimes                                = 5
+    DisableOutputRetryTimes                                = 5,
+    LivenessCheckPeriodMs                                  = 2000,
+    MissedLivenessChecksBeforeRemoval                      = 3,
+    AddressesProbedPerMonitorCycle                         = 16,
+    ConnectivityThreshold                                  = 1,
+    WiggleMaxPairs                                         = 64,
+    WiggleMinSummaryPeriodMs                               = 100,
+    WiggleFailedPassDelayMs                                = 100,
+    WiggleMaxFailedPasses                                  = 10,
+    MonitoringFailedSweepDelayMs                           = 500,
+    MonitoringMaxFailedSweeps                              = 10,
+    OversamplingConfidenceSteps                            = 3,
+    OversamplingDecisionLevel                              = 8,
+    OversamplingClearLevel                                 = 32,
+    AcquisitionCacheWindowMs                               = 0,
+    AcquisitionCacheEntries                                = 4
 };
 
 constexpr float LOW_OUTPUT_VOLTAGE_VALUE     = 0.693f;
@@ -38,16 +53,15 @@ enum Tasks {
     DefaultTasksCore           = 0,
     VoltageCheckTaskPio        = 7,
     VoltageCheckTaskStackSize  = 4096,
-    CommunicatorWritePrio      = 5,
-    CommunicatorWriteStackSize = 4096,
-    CommunicatorWriteTaskCore  = 0,
-    CommunicatorReadPrio       = 6,
-    CommunicatorReadTaskSize   = 8192,
-    CommunicatorReadTaskCore   = 1,
+    CommunicatorIoPrio         = 6,
+    CommunicatorIoStackSize    = 4096,
+    CommunicatorIoTaskCore     = 1,
     MainStackSize              = 4096,
     MainPrio                   = 1,
     CommandManagerStackSize    = 4096,
     CommandManagerPrio         = 5,
+    BoardsMonitorStackSize     = 4096,
+    BoardsMonitorPrio          = 3,
 };
 
 enum class EnableLogForComponent : bool {
@@ -65,11 +79,30 @@ enum Log {
 };
 
 enum TimeoutMs {
-    VoltagesQueueReceive = 1000
+    VoltagesQueueReceive = 1000,
+    BoardsEventSend      = 100
 };
 
 enum Socket {
-    EntryPortNumber = 1500
+    EntryPortNumber            = 1500,
+    WriteCoalescingBudgetBytes = 1460,
+    ReceiveBufferSize          = 256,
+    MasterSilenceTimeoutMs     = 15000,
+    OutboundFramesNumber       = 8,
+    OutboundFrameCapacity      = 256,
+    CommandsQueueLength        = 32,
+    ControlQueueLength         = 8,
+    ReplayMessagesNumber       = 32,
+    ReconnectBackoffInitialMs  = 50,
+    ReconnectBackoffMaxMs      = 800,
+    DirectReconnectAttempts    = 3,
+    ResumeWaitMs               = 1000,
+    ObserverPortNumber         = 1501,
+    MaxObservers               = 2,
+    ObserverQueueLength        = 8,
+    TelemetryMinIntervalMs     = 100,
+    DeltaKeyframeInterval      = 32,
+    DeltaHistoryFrames         = 4
 };
 
 enum FailHandle {
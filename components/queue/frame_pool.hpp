@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "queue.hpp"
+
+/**
+ * @brief fixed set of preallocated outbound frames shared by many producers and one consumer. Producers Claim() free
+ * frame with atomic operation, fill it in place and Commit() it, consumer takes committed frames in commit order and
+ * Release()s them after use. No heap is used after construction.
+ */
+template<size_t FramesNumber, size_t FrameCapacity>
+class FramePool {
+  public:
+    using Byte        = uint8_t;
+    using FrameIndex  = uint8_t;
+    using TimeoutMsec = portTickType;
+    using FreeMaskT   = uint32_t;
+
+    static_assert(FramesNumber > 0 and FramesNumber <= sizeof(FreeMaskT) * 8, "frames are tracked by bits of one word");
+
+    /**
+     * @brief frame length precedes frame bytes in memory, so length prefix and payload go to socket as one buffer.
+     * isPrivate is set by producer and interpreted by consumer only
+     */
+    struct Frame {
+        size_t                         size;
+        std::array<Byte, FrameCapacity> bytes;
+        bool                           isPrivate;
+    };
+
+    static_assert(offsetof(Frame, bytes) == sizeof(size_t), "length prefix must be contiguous with frame bytes");
+
+    auto constexpr static capacity = FrameCapacity;
+
+    FramePool() noexcept
+      : freeFramesCount{ xSemaphoreCreateCounting(FramesNumber, FramesNumber) }
+      , committedFrames{ FramesNumber }
+    {
+        configASSERT(freeFramesCount != nullptr);
+    }
+    FramePool(FramePool const &)            = delete;
+    FramePool &operator=(FramePool const &) = delete;
+    ~FramePool() noexcept { vSemaphoreDelete(freeFramesCount); }
+
+    /**
+     * @brief blocks until any frame is free or timeout expires, safe to call from any task
+     */
+    std::optional<FrameIndex> Claim(TimeoutMsec timeoutMsec = portMAX_DELAY) noexcept
+    {
+        if (timeoutMsec != portMAX_DELAY)
+            timeoutMsec = pdMS_TO_TICKS(timeoutMsec);
+
+        if (xSemaphoreTake(freeFramesCount, timeoutMsec) != pdTRUE)
+            return std::nullopt;
+
+        // semaphore guarantees at least one bit is set for this claimer
+        auto mask = freeMask.load(std::memory_order_relaxed);
+        while (true) {
+            auto index = static_cast<FrameIndex>(__builtin_ctz(mask));
+
+            if (freeMask.compare_exchange_weak(mask,
+                                               mask & ~(FreeMaskT{ 1 } << index),
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+                return index;
+        }
+    }
+    [[nodiscard]] Frame &At(FrameIndex index) noexcept { return frames[index]; }
+
+    /**
+     * @brief hands filled frame to consumer, never blocks because number of committed frames can not exceed pool size
+     */
+    void Commit(FrameIndex index) noexcept { committedFrames.SendImmediate(index); }
+
+    /**
+     * @brief consumer side, does not block
+     */
+    std::optional<FrameIndex> TakeCommitted() noexcept { return committedFrames.Receive(0); }
+    void                      Release(FrameIndex index) noexcept
+    {
+        freeMask.fetch_or(FreeMaskT{ 1 } << index, std::memory_order_release);
+        xSemaphoreGive(freeFramesCount);
+    }
+
+  private:
+    std::array<Frame, FramesNumber> frames{};
+    std::atomic<FreeMaskT>          freeMask{ (FramesNumber == sizeof(FreeMaskT) * 8)
+                                                ? ~FreeMaskT{ 0 }
+                                                : (FreeMaskT{ 1 } << FramesNumber) - 1 };
+    SemaphoreHandle_t               freeFramesCount;
+    Queue<FrameIndex>               committedFrames;
+};
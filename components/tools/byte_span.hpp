@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief non owning view of contiguous bytes, minimal replacement of std::span<const uint8_t> which is not available
+ * in toolchain's standard library
+ */
+class ByteSpan {
+  public:
+    using Byte = uint8_t;
+
+    constexpr ByteSpan() noexcept = default;
+    constexpr ByteSpan(Byte const *first_byte, size_t bytes_num) noexcept
+      : bytes{ first_byte }
+      , bytesNum{ bytes_num }
+    { }
+
+    [[nodiscard]] constexpr Byte const *data() const noexcept { return bytes; }
+    [[nodiscard]] constexpr size_t      size() const noexcept { return bytesNum; }
+    [[nodiscard]] constexpr bool        empty() const noexcept { return bytesNum == 0; }
+    [[nodiscard]] constexpr Byte const *begin() const noexcept { return bytes; }
+    [[nodiscard]] constexpr Byte const *end() const noexcept { return bytes + bytesNum; }
+    [[nodiscard]] constexpr Byte        operator[](size_t idx) const noexcept { return bytes[idx]; }
+
+    /**
+     * @brief view of bytes starting at offset, empty if offset is beyond the end
+     */
+    [[nodiscard]] constexpr ByteSpan subspan(size_t offset) const noexcept
+    {
+        if (offset >= bytesNum)
+            return ByteSpan{};
+
+        return ByteSpan{ bytes + offset, bytesNum - offset };
+    }
+
+  private:
+    Byte const *bytes    = nullptr;
+    size_t      bytesNum = 0;
+};
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Host-side listener of scan telemetry stream.
+
+Controller sends ScanTelemetry datagrams to the UDP port given in SubscribeTelemetry command, this script binds that
+port and prints every datagram decoded. Layout (all numbers little endian, 20 bytes):
+[id = 63][datagram number, 2][state][scan requestId, 2][board][pin][pins done, 2][pins total, 2]
+[pins per second, 2][pin failures, 2][link errors, 2][eta seconds, 2]
+
+    telemetry_listener.py --port 1502
+    telemetry_listener.py --port 1502 --send-sample 127.0.0.1   # loopback check of decoding without controller
+"""
+import argparse
+import socket
+import struct
+
+MSG_ID = 63
+LAYOUT = struct.Struct("<BHBHBBHHHHHH")
+STATES = {0: "Idle", 1: "Scanning", 2: "Paused"}
+UNKNOWN_ETA = 0xFFFF
+
+
+def decode(datagram):
+    if len(datagram) != LAYOUT.size or datagram[0] != MSG_ID:
+        raise ValueError("not a ScanTelemetry datagram: " + datagram.hex())
+
+    (_, number, state, request_id, board, pin, done, total, pins_per_second, failures, link_errors,
+     eta) = LAYOUT.unpack(datagram)
+
+    return {
+        "number": number,
+        "state": STATES.get(state, str(state)),
+        "requestId": request_id,
+        "board": board,
+        "pin": pin,
+        "done": done,
+        "total": total,
+        "pinsPerSecond": pins_per_second,
+        "failures": failures,
+        "linkErrors": link_errors,
+        "etaSeconds": None if eta == UNKNOWN_ETA else eta,
+    }
+
+
+def encode_sample(number):
+    return LAYOUT.pack(MSG_ID, number, 1, 7, 3, 12, 40, 128, 25, 1, 0, 3)
+
+
+def format_telemetry(telemetry):
+    eta = "?" if telemetry["etaSeconds"] is None else "{}s".format(telemetry["etaSeconds"])
+    return ("#{number:<5} {state:<8} req {requestId:<5} at {board}:{pin:<3} {done}/{total} pins "
+            "{pinsPerSecond} pin/s failures {failures} link errors {linkErrors} eta ").format(**telemetry) + eta
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=1502, help="UDP port given in SubscribeTelemetry")
+    parser.add_argument("--bind", default="0.0.0.0", help="local address to listen on")
+    parser.add_argument("--send-sample", metavar="HOST", help="send few sample datagrams to HOST:port and exit")
+    parser.add_argument("--count", type=int, default=0, help="exit after this many datagrams, 0 listens forever")
+    args = parser.parse_args()
+
+    if args.send_sample:
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sender:
+            for number in range(3):
+                sender.sendto(encode_sample(number), (args.send_sample, args.port))
+        return
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as listener:
+        listener.bind((args.bind, args.port))
+        print("listening for telemetry on {}:{}".format(args.bind, args.port))
+
+        received = 0
+        last_number = None
+        while args.count == 0 or received < args.count:
+            datagram, sender = listener.recvfrom(64)
+            try:
+                telemetry = decode(datagram)
+            except ValueError as error:
+                print("{}: {}".format(sender[0], error))
+                continue
+
+            # datagrams are fire-and-forget, gaps in numbering are lost ones
+            if last_number is not None and telemetry["number"] != (last_number + 1) & 0xFFFF:
+                print("{}: lost datagrams before #{}".format(sender[0], telemetry["number"]))
+            last_number = telemetry["number"]
+
+            print("{}: {}".format(sender[0], format_telemetry(telemetry)))
+            received += 1
+
+
+if __name__ == "__main__":
+    main()